@@ -8,11 +8,11 @@ OledMenu menu(u8g2, 1024, 500);
 
 void setup() {
     // Initialize the display
-    menu.initDisplay();
+    menu.init();
     menu.setText("Hello, World!");
 }
 
 void loop() {
     // Display a page
-    menu.update();
+    menu.refreshDisplay();
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+// Simulated display, counts the bytes that would go over the I2C bus
+SimulatedDisplay display(MENU::sim::FULL_BUFFER, 400000);
+
+const int iterations = 50;
+const uint16_t lineCounts[] = {4, 8, 16, 32};
+const uint16_t lineLengths[] = {8, 20};
+
+// Page content generated by the benchmark callback
+uint16_t benchLines = 4;
+uint16_t benchLineLength = 8;
+uint16_t benchCounter = 0;
+char pageBuffer[32 * 21 + 1];
+uint8_t scrollCanvas[8192];
+uint8_t lineCache[4096];
+
+void benchPage(MENU::structs::menuPageInfo *page_info) {
+    uint16_t pos = 0;
+    for (uint16_t line = 0; line < benchLines; line++) {
+        for (uint16_t col = 0; col < benchLineLength; col++) {
+            page_info->buffer[pos++] = 'A' + (line + col) % 26;
+        }
+        page_info->buffer[pos++] = '\n';
+    }
+    // Last character changes with the counter so "changed" frames differ by one glyph
+    page_info->buffer[pos - 2] = '0' + benchCounter % 10;
+    page_info->buffer[pos] = '\0';
+    page_info->needs_buffer_size = pos + 1;
+}
+
+void printResult(const char *name, unsigned long totalMicros, uint32_t busBytes) {
+    Serial.print(name);
+    Serial.print(F(": "));
+    Serial.print(totalMicros / iterations);
+    Serial.print(F(" us/op, "));
+    Serial.print(busBytes / iterations);
+    Serial.println(F(" bus bytes/op"));
+}
+
+void runBenchmark(uint16_t lines, uint16_t lineLength) {
+    benchLines = lines;
+    benchLineLength = lineLength;
+    benchCounter = 0;
+
+    StaticOledMenu<1> menu(display, 1024, 500);
+    menu.init();
+
+    Serial.print(F("--- "));
+    Serial.print(lines);
+    Serial.print(F(" lines x "));
+    Serial.print(lineLength);
+    Serial.println(F(" chars ---"));
+
+    unsigned long start = micros();
+    menu.addMenuPage(MENU::structs::USER, true, benchPage, pageBuffer, sizeof(pageBuffer));
+    Serial.print(F("addMenuPage: "));
+    Serial.print(micros() - start);
+    Serial.println(F(" us"));
+
+    // Full redraw of the same content
+    menu.refreshDisplay();
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.invalidateDisplay();
+        menu.displayText(false);
+    }
+    printResult("displayText (forced)", micros() - start, display.getBusStats().bytes_sent);
+
+    // Same forced redraw with line bitmaps copied from the line cache
+    menu.setLineCache(lineCache, sizeof(lineCache));
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.invalidateDisplay();
+        menu.displayText(false);
+    }
+    printResult("displayText (forced, line cache)", micros() - start, display.getBusStats().bytes_sent);
+    Serial.print(F("line cache hits/misses: "));
+    Serial.print(menu.getLineCacheHits());
+    Serial.print(F("/"));
+    Serial.println(menu.getLineCacheMisses());
+    menu.setLineCache(nullptr, 0);
+
+    // Unchanged content
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.refreshDisplay();
+    }
+    printResult("refreshDisplay (unchanged)", micros() - start, display.getBusStats().bytes_sent);
+
+    // One glyph changes every frame
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        benchCounter++;
+        menu.refreshDisplay();
+    }
+    printResult("refreshDisplay (changed)", micros() - start, display.getBusStats().bytes_sent);
+
+    // Same frame sequence with dirty tile tracking
+    menu.setDirtyTileTracking(true);
+    menu.refreshDisplay();
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        benchCounter++;
+        menu.refreshDisplay();
+    }
+    printResult("refreshDisplay (changed, dirty tiles)", micros() - start, display.getBusStats().bytes_sent);
+    menu.setDirtyTileTracking(false);
+
+    // Scroll one pixel down and redraw
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.scroll(0, 1);
+        menu.refreshDisplay();
+    }
+    printResult("scroll + refreshDisplay", micros() - start, display.getBusStats().bytes_sent);
+
+    // Same scroll with the page rendered once into a canvas, pages too large for it are drawn directly
+    menu.setScrollCanvas(scrollCanvas, sizeof(scrollCanvas));
+    display.resetBusStats();
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.scroll(0, -1);
+        menu.refreshDisplay();
+    }
+    printResult("scroll + refreshDisplay (canvas)", micros() - start, display.getBusStats().bytes_sent);
+    Serial.print(F("canvas renders: "));
+    Serial.println(menu.getCanvasRenders());
+    menu.setScrollCanvas(nullptr, 0);
+
+    Serial.print(F("frames drawn/skipped: "));
+    Serial.print(menu.getFramesDrawn());
+    Serial.print(F("/"));
+    Serial.println(menu.getFramesSkipped());
+    menu.printMemoryFootprint(Serial);
+#if defined(OLED_MENU_ENABLE_STATS)
+    // Build with -DOLED_MENU_ENABLE_STATS to see where the frame time goes
+    menu.printRenderStats(Serial);
+#endif
+}
+
+void runBufferModeBenchmark(MENU::sim::BUFFER_MODE mode, const char *name) {
+    SimulatedDisplay modeDisplay(mode, 400000);
+    benchLines = 8;
+    benchLineLength = 20;
+    benchCounter = 0;
+
+    StaticOledMenu<1> menu(modeDisplay, 1024, 500);
+    menu.init();
+    menu.addMenuPage(MENU::structs::USER, true, benchPage, pageBuffer, sizeof(pageBuffer));
+    menu.refreshDisplay();
+
+    modeDisplay.resetBusStats();
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; i++) {
+        menu.invalidateDisplay();
+        menu.displayText(false);
+    }
+    unsigned long frameMicros = (micros() - start) / iterations;
+
+    Serial.print(name);
+    Serial.print(F(": frame buffer "));
+    Serial.print(modeDisplay.getFrameBufferSize());
+    Serial.print(F(" bytes, menu RAM "));
+    Serial.print(static_cast<unsigned long>(menu.getMemoryFootprint().total));
+    Serial.print(F(" bytes, "));
+    Serial.print(frameMicros);
+    Serial.print(F(" us/frame, "));
+    Serial.print(modeDisplay.getBusMicros() / iterations);
+    Serial.println(F(" us bus/frame"));
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(100);
+    Serial.println(F("U8G2OledMenu benchmark"));
+    Serial.print(F("frame buffer: "));
+    Serial.print(display.getFrameBufferSize());
+    Serial.println(F(" bytes"));
+
+    for (uint16_t l = 0; l < NELEMS(lineCounts); l++) {
+        for (uint16_t c = 0; c < NELEMS(lineLengths); c++) {
+            runBenchmark(lineCounts[l], lineLengths[c]);
+        }
+    }
+
+    Serial.println(F("--- RAM versus frame time, 8 lines x 20 chars ---"));
+    runBufferModeBenchmark(MENU::sim::FULL_BUFFER, "full buffer");
+    runBufferModeBenchmark(MENU::sim::PAGE_BUFFER_2, "page buffer _2");
+    runBufferModeBenchmark(MENU::sim::PAGE_BUFFER_1, "page buffer _1");
+    Serial.println(F("done"));
+}
+
+void loop() {
+}
@@ -0,0 +1,400 @@
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+// Renders scripted scenarios into the simulated frame buffer and compares a hash of every frame with the
+// golden table below, so optimizations that change what is drawn are caught. Every scenario also has budgets
+// for CPU time, draw calls and bus bytes. Scenarios that only enable an optimization must draw exactly the
+// frame of the scenario they name.
+//
+// Build with -DRECORD_GOLDEN to print a new table. Check the frames it prints, then paste the table over
+// expected[]. Entries of 0 are not recorded yet and are not checked, a board without a table only compares the
+// optimizations with their scenario. The host build in extras/host runs this sketch as GoldenImagesTest against
+// the host table and the frames in extras/host/golden, which it writes when built with RECORD_GOLDEN. Host
+// glyphs are a fixed pattern, so the host frames check layout, not the look of real fonts.
+SimulatedDisplay display(MENU::sim::FULL_BUFFER, 400000);
+
+char pageBuffer[256];
+uint8_t lineCache[2048];
+uint8_t scrollCanvas[4096];
+MENU::structs::wrapCache wrapCache;
+uint8_t otaParameters[2] = {42, 100};
+
+void weatherPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Temperature 21.5\nHumidity 40 %%\nPressure 1013\nWind 12 km/h\n"
+                                            "Rain 0 mm\nBattery 87 %%\nUptime 3 d\nFirmware 1.4.2\n") + 1;
+}
+
+void notePage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Long lines are wrapped at spaces to the width of the display.\n") + 1;
+}
+
+void showWeather(OledMenu &menu, int lines) {
+    menu.setNumberOfDisplayLines(lines);
+    menu.addMenuPage(MENU::structs::USER, true, weatherPage, pageBuffer, sizeof(pageBuffer));
+    menu.refreshDisplay();
+    // The default anchor puts the first baseline on the top edge, move it below the first line
+    menu.setDisplayAnchor(0, 0);
+    menu.refreshDisplay();
+}
+
+// Font sizes selected by the number of display lines, one or two lines are taller than the largest font of the
+// lookup table and get the fallback font
+void lines1(OledMenu &menu) { showWeather(menu, 1); }
+void lines3(OledMenu &menu) { showWeather(menu, 3); }
+void lines4(OledMenu &menu) { showWeather(menu, 4); }
+void lines5(OledMenu &menu) { showWeather(menu, 5); }
+void lines6(OledMenu &menu) { showWeather(menu, 6); }
+void lines8(OledMenu &menu) { showWeather(menu, 8); }
+void lines10(OledMenu &menu) { showWeather(menu, 10); }
+
+void anchor(OledMenu &menu) {
+    showWeather(menu, 4);
+    menu.setDisplayAnchor(12, 20);
+    menu.refreshDisplay();
+}
+
+void scrolled(OledMenu &menu) {
+    showWeather(menu, 4);
+    menu.scroll(0, 64);
+    menu.refreshDisplay();
+}
+
+void cursor(OledMenu &menu) {
+    showWeather(menu, 4);
+    menu.setCursorPosition(20, 16);
+    menu.displayText(true);
+}
+
+void highlight(OledMenu &menu) {
+    menu.highlightEnabled = true;
+    showWeather(menu, 4);
+}
+
+void errorOverride(OledMenu &menu) {
+    showWeather(menu, 4);
+    menu.showErrorMessage("Sensor %d offline", 3);
+    menu.refreshDisplay();
+}
+
+// Built-in OTA page at 42 %, its spinner only moves 100 ms after the first call
+void otaInfoPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->parameters = otaParameters;
+    MENU::builtin_pages::OTAInfo(page_info);
+}
+
+void otaPage(OledMenu &menu) {
+    menu.addMenuPage(MENU::structs::USER, false, otaInfoPage, pageBuffer, sizeof(pageBuffer));
+    menu.refreshDisplay();
+    // The default anchor puts the first baseline on the top edge, move it below the first line
+    menu.setDisplayAnchor(0, 0);
+    menu.refreshDisplay();
+}
+
+void wordWrap(OledMenu &menu) {
+    menu.setNumberOfDisplayLines(3);
+    menu.setWordWrap(&wrapCache);
+    menu.addMenuPage(MENU::structs::USER, false, notePage, pageBuffer, sizeof(pageBuffer));
+    menu.refreshDisplay();
+    // The default anchor puts the first baseline on the top edge, move it below the first line
+    menu.setDisplayAnchor(0, 0);
+    menu.refreshDisplay();
+}
+
+// The same frames with an optimization enabled, drawn twice so the second frame can profit from it
+void redrawWeather(OledMenu &menu) {
+    showWeather(menu, 4);
+    menu.invalidateDisplay();
+    menu.refreshDisplay();
+}
+
+void lines4Twice(OledMenu &menu) { redrawWeather(menu); }
+
+void dirtyTiles(OledMenu &menu) {
+    menu.setDirtyTileTracking(true);
+    redrawWeather(menu);
+}
+
+void lineCacheOn(OledMenu &menu) {
+    menu.setLineCache(lineCache, sizeof(lineCache));
+    redrawWeather(menu);
+}
+
+void asyncFlush(OledMenu &menu) {
+    menu.setAsyncFlush(true, 2);
+    redrawWeather(menu);
+    while (menu.isFlushInProgress()) {
+        menu.service();
+    }
+}
+
+void scrollCanvasOn(OledMenu &menu) {
+    menu.setScrollCanvas(scrollCanvas, sizeof(scrollCanvas));
+    scrolled(menu);
+}
+
+struct scenario {
+    const char *name;
+    void (*run)(OledMenu &menu);
+    const char *same_as; // Scenario that must draw the same frame, nullptr if none
+};
+
+struct expectation {
+    uint32_t golden;         // FNV-1a hash of the frame buffer, 0 if not recorded
+    uint32_t max_us;         // CPU time budget, 0 if not recorded
+    uint32_t max_draw_calls; // Draw call budget, 0 if not recorded
+    uint32_t max_bus_bytes;  // Bus byte budget, 0 if not recorded
+};
+
+const scenario scenarios[] = {
+    {"lines_1", lines1, nullptr},
+    {"lines_3", lines3, nullptr},
+    {"lines_4", lines4, nullptr},
+    {"lines_5", lines5, nullptr},
+    {"lines_6", lines6, nullptr},
+    {"lines_8", lines8, nullptr},
+    {"lines_10", lines10, nullptr},
+    {"anchor", anchor, nullptr},
+    {"scroll", scrolled, nullptr},
+    {"cursor", cursor, nullptr},
+    {"highlight", highlight, nullptr},
+    {"error_override", errorOverride, nullptr},
+    {"ota_page", otaPage, nullptr},
+    {"word_wrap", wordWrap, nullptr},
+    {"lines_4_twice", lines4Twice, "lines_4"},
+    {"dirty_tiles", dirtyTiles, "lines_4"},
+    {"line_cache", lineCacheOn, "lines_4"},
+    {"async_flush", asyncFlush, "lines_4"},
+    {"scroll_canvas", scrollCanvasOn, "scroll"},
+};
+
+#if defined(OLED_MENU_HOST)
+// Recorded on the host with -DOLED_MENU_HOST_RECORD_GOLDEN=ON, one entry per scenario
+const expectation expected[] = {
+    {0x05B44A57UL, 10280, 15, 2048}, // lines_1
+    {0xF6AB305BUL, 10400, 7, 2048}, // lines_3
+    {0x2C379DC0UL, 10280, 9, 2048}, // lines_4
+    {0x71D7F8DCUL, 10220, 11, 2048}, // lines_5
+    {0xE6BE893DUL, 10160, 11, 2048}, // lines_6
+    {0xE73070FDUL, 10140, 13, 2048}, // lines_8
+    {0x341C3E25UL, 10120, 16, 2048}, // lines_10
+    {0x45607453UL, 10690, 12, 3072}, // anchor
+    {0xE00F4B52UL, 10390, 13, 3072}, // scroll
+    {0x49DABF0EUL, 10380, 17, 3072}, // cursor
+    {0x422F51C5UL, 10560, 18, 2048}, // highlight
+    {0x234B999BUL, 10380, 10, 3072}, // error_override
+    {0xF6B354C3UL, 10180, 4, 2048}, // ota_page
+    {0x16F0A6DAUL, 10160, 7, 2048}, // word_wrap
+    {0x2C379DC0UL, 10370, 13, 3072}, // lines_4_twice
+    {0x2C379DC0UL, 10390, 13, 2024}, // dirty_tiles
+    {0x2C379DC0UL, 10410, 10, 3072}, // line_cache
+    {0x2C379DC0UL, 10380, 13, 1024}, // async_flush
+    {0xE00F4B52UL, 10390, 13, 3072}, // scroll_canvas
+};
+#else
+// Not recorded on a board yet, build with -DRECORD_GOLDEN on the reference board and paste its table here
+const expectation expected[] = {
+    {0, 0, 0, 0}, // lines_1
+    {0, 0, 0, 0}, // lines_3
+    {0, 0, 0, 0}, // lines_4
+    {0, 0, 0, 0}, // lines_5
+    {0, 0, 0, 0}, // lines_6
+    {0, 0, 0, 0}, // lines_8
+    {0, 0, 0, 0}, // lines_10
+    {0, 0, 0, 0}, // anchor
+    {0, 0, 0, 0}, // scroll
+    {0, 0, 0, 0}, // cursor
+    {0, 0, 0, 0}, // highlight
+    {0, 0, 0, 0}, // error_override
+    {0, 0, 0, 0}, // ota_page
+    {0, 0, 0, 0}, // word_wrap
+    {0, 0, 0, 0}, // lines_4_twice
+    {0, 0, 0, 0}, // dirty_tiles
+    {0, 0, 0, 0}, // line_cache
+    {0, 0, 0, 0}, // async_flush
+    {0, 0, 0, 0}, // scroll_canvas
+};
+#endif
+
+static_assert(NELEMS(expected) == NELEMS(scenarios), "One expected entry per scenario");
+
+#if defined(OLED_MENU_HOST)
+// Compares the frame with extras/host/golden/<name>.pbm, defined by extras/host/tests/GoldenImagesTest.cpp
+bool checkHostFrame(const char *name);
+#endif
+
+expectation measured[NELEMS(scenarios)];
+uint8_t goldenFailures = 0; // Failed scenarios of the last run, the host test exits with 1 if any failed
+
+uint32_t hashFrame() {
+    uint32_t hash = 2166136261UL;
+    uint8_t *frame = display.getBufferPtr();
+    for (uint16_t i = 0; i < display.getFrameBufferSize(); i++) {
+        hash = (hash ^ frame[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+void printFrame() {
+    for (uint8_t y = 0; y < display.getDisplayHeight(); y++) {
+        for (uint8_t x = 0; x < display.getDisplayWidth(); x++) {
+            uint8_t column = display.getBufferPtr()[(y / 8) * display.getDisplayWidth() + x];
+            Serial.print((column >> (y % 8)) & 1 ? '#' : '.');
+        }
+        Serial.println();
+    }
+}
+
+void printHex(uint32_t value) {
+    Serial.print(F("0x"));
+    for (int8_t shift = 28; shift >= 0; shift -= 4) {
+        Serial.print((value >> shift) & 0xF, HEX);
+    }
+}
+
+int8_t findScenario(const char *name) {
+    for (uint8_t i = 0; i < NELEMS(scenarios); i++) {
+        if (strcmp(scenarios[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool checkBudget(const __FlashStringHelper *what, uint32_t value, uint32_t budget) {
+    if (budget == 0 || value <= budget) {
+        return true;
+    }
+    Serial.print(F("  over budget: "));
+    Serial.print(what);
+    Serial.print(' ');
+    Serial.print(value);
+    Serial.print(F(" > "));
+    Serial.println(budget);
+    return false;
+}
+
+bool runScenario(uint8_t index) {
+    const scenario &test = scenarios[index];
+    StaticOledMenu<2> menu(display, 512, 500);
+    menu.init();
+    display.clearBuffer();
+    display.resetBusStats();
+
+    unsigned long start = micros();
+    test.run(menu);
+    expectation &result = measured[index];
+    result.max_us = micros() - start;
+    result.golden = hashFrame();
+    result.max_draw_calls = menu.getDrawCalls();
+    result.max_bus_bytes = display.getBusStats().bytes_sent;
+
+#if defined(RECORD_GOLDEN)
+    Serial.print(F("--- "));
+    Serial.println(test.name);
+    printFrame();
+#if defined(OLED_MENU_HOST)
+    checkHostFrame(test.name);
+#endif
+    return true;
+#else
+    const expectation &budget = expected[index];
+    bool passed = true;
+    if (budget.golden != 0 && result.golden != budget.golden) {
+        Serial.print(F("  frame differs from the golden image "));
+        printHex(budget.golden);
+        Serial.println();
+        passed = false;
+    }
+#if defined(OLED_MENU_HOST)
+    passed &= checkHostFrame(test.name);
+#endif
+    if (test.same_as != nullptr) {
+        int8_t reference = findScenario(test.same_as);
+        if (reference >= 0 && reference < index && measured[reference].golden != result.golden) {
+            Serial.print(F("  frame differs from "));
+            Serial.println(test.same_as);
+            passed = false;
+        }
+    }
+    passed &= checkBudget(F("us"), result.max_us, budget.max_us);
+    passed &= checkBudget(F("draw calls"), result.max_draw_calls, budget.max_draw_calls);
+    passed &= checkBudget(F("bus bytes"), result.max_bus_bytes, budget.max_bus_bytes);
+
+    Serial.print(passed ? F("PASS ") : F("FAIL "));
+    Serial.print(test.name);
+    Serial.print(F(" hash="));
+    printHex(result.golden);
+    Serial.print(F(" us="));
+    Serial.print(result.max_us);
+    Serial.print(F(" draw_calls="));
+    Serial.print(result.max_draw_calls);
+    Serial.print(F(" bus_bytes="));
+    Serial.println(result.max_bus_bytes);
+    if (!passed) {
+        printFrame();
+    }
+    return passed;
+#endif
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(100);
+
+#if !defined(RECORD_GOLDEN)
+    bool recorded = false;
+    for (uint8_t i = 0; i < NELEMS(expected); i++) {
+        recorded |= expected[i].golden != 0;
+    }
+    if (!recorded) {
+        Serial.println(F("No golden table for this board, only the optimizations are compared with their scenario."));
+        Serial.println(F("Build with -DRECORD_GOLDEN to print one."));
+    }
+#endif
+
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < NELEMS(scenarios); i++) {
+        failed += runScenario(i) ? 0 : 1;
+    }
+    goldenFailures = failed;
+
+#if defined(RECORD_GOLDEN)
+    // CPU time gets headroom for timing jitter, draw calls and bus bytes are deterministic. A desktop is
+    // shared with other processes and may run the sketch under a sanitizer, so the host gets a lot more.
+    Serial.println(F("const expectation expected[] = {"));
+    for (uint8_t i = 0; i < NELEMS(scenarios); i++) {
+        Serial.print(F("    {"));
+        printHex(measured[i].golden);
+        Serial.print(F("UL, "));
+#if defined(OLED_MENU_HOST)
+        Serial.print(measured[i].max_us * 10 + 10000);
+#else
+        Serial.print(measured[i].max_us + measured[i].max_us / 4 + 1);
+#endif
+        Serial.print(F(", "));
+        Serial.print(measured[i].max_draw_calls);
+        Serial.print(F(", "));
+        Serial.print(measured[i].max_bus_bytes);
+        Serial.print(F("}, // "));
+        Serial.println(scenarios[i].name);
+    }
+    Serial.println(F("};"));
+#else
+    uint8_t unrecorded = 0;
+    for (uint8_t i = 0; i < NELEMS(expected); i++) {
+        unrecorded += expected[i].golden == 0 ? 1 : 0;
+    }
+    Serial.print(NELEMS(scenarios) - failed);
+    Serial.print(F(" passed, "));
+    Serial.print(failed);
+    Serial.print(F(" failed, "));
+    Serial.print(unrecorded);
+    Serial.println(F(" without golden image"));
+    Serial.println(failed == 0 ? F("OK") : F("FAILED"));
+#endif
+}
+
+void loop() {
+}
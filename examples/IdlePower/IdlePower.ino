@@ -0,0 +1,41 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+OledMenu menu(u8g2, 512, 500);
+
+const uint8_t buttonPin = 2;
+
+char statusBuffer[64];
+
+void statusPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Status\nUptime %lu s\nA0 %d\n", millis() / 1000, analogRead(A0)) + 1;
+}
+
+void onButton() {
+    // Safe from an interrupt, the display wakes on the next refreshDisplay()
+    menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+}
+
+void setup() {
+    pinMode(buttonPin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(buttonPin), onButton, FALLING);
+    menu.init();
+    menu.addMenuPage(MENU::structs::USER, true, statusPage, statusBuffer, sizeof(statusBuffer));
+
+    // Dim after 10 s without input, switch the display off after 60 s
+    menu.setIdlePolicy(10000, 60000);
+}
+
+void loop() {
+    menu.refreshDisplay();
+
+    // Nothing is scheduled while the display is off, wait in 100 ms steps so a press is seen quickly
+    uint32_t wait = menu.getNextRefreshDeadline();
+    if (wait == OLED_MENU_NO_DEADLINE) {
+        wait = 100;
+    }
+    delay(wait < 100 ? wait : 100);
+}
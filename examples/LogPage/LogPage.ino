@@ -0,0 +1,40 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display, a full frame buffer lets new lines scroll the last frame
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+OledMenu menu(u8g2, 512, 500);
+
+// The newest 32 lines of up to 23 characters, older lines are overwritten
+char logLines[32 * 24];
+MENU::structs::logPage statusLog(logLines, 32, 24);
+
+// Only the visible lines are copied here
+char logWindow[128];
+
+void setup() {
+    Serial.begin(115200);
+    menu.init();
+    menu.addLogPage(true, &statusLog, logWindow, sizeof(logWindow));
+    OledMenu::appendLog(&statusLog, "Booted");
+}
+
+void loop() {
+    // A new status line every second costs one append, the display only draws the new line
+    static unsigned long lastLine = 0;
+    if (millis() - lastLine >= 1000) {
+        lastLine = millis();
+        OledMenu::appendLog(&statusLog, "%lu s: A0=%d", millis() / 1000, analogRead(A0));
+    }
+
+    // "u" scrolls back, "d" scrolls forward, back at the newest line the page follows new lines again
+    if (Serial.available()) {
+        char c = Serial.read();
+        if (c == 'u') {
+            menu.moveUpMenuItem();
+        } else if (c == 'd') {
+            menu.moveDownMenuItem();
+        }
+    }
+    menu.refreshDisplay();
+}
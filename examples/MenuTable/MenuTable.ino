@@ -0,0 +1,39 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+// Page callback, runs on every refresh of its page
+void uptimePage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Uptime\n%lu s\n", millis() / 1000) + 1;
+}
+
+// Static page text, copied once into the page buffer
+constexpr char aboutText[] PROGMEM = "U8G2OledMenu\nMenu table\nexample\n";
+
+// Whole menu, checked at compile time and kept in flash
+constexpr MENU::structs::menuPageDef menuTable[] PROGMEM = {
+    {MENU::structs::USER, false, nullptr, aboutText, 40},
+    {MENU::structs::USER, false, uptimePage, nullptr, 24},
+};
+
+// Page buffers sized from the table
+OLED_MENU_TABLE_BUFFERS(menuTable, menuBuffers);
+
+// Menu with a page table sized for the menu table and a 512 byte display buffer, nothing is allocated
+StaticOledMenu<NELEMS(menuTable), 1, 512> menu(u8g2, 500);
+
+void setup() {
+    menu.init();
+    menu.loadMenuTable(menuTable, NELEMS(menuTable), menuBuffers, sizeof(menuBuffers));
+}
+
+void loop() {
+    static unsigned long lastPageChange = 0;
+    if (millis() - lastPageChange >= 3000) {
+        lastPageChange = millis();
+        menu.moveToNextPage();
+    }
+    menu.refreshDisplay();
+}
@@ -0,0 +1,36 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display, the mirror needs a full frame buffer
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+OledMenu menu(u8g2, 512, 500);
+
+char statusBuffer[64];
+
+void statusPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Status\nUptime %lu s\nA0 %d\n", millis() / 1000, analogRead(A0)) + 1;
+}
+
+void setup() {
+    // Save the serial output and rebuild the frames on the host:
+    //   python3 extras/mirror_decode.py /dev/ttyUSB0 frames/ --latest
+    Serial.begin(115200);
+    menu.init();
+    menu.addMenuPage(MENU::structs::USER, false, statusPage, statusBuffer, sizeof(statusBuffer));
+
+    // Only the tiles that change are written, a full frame every 100 frames lets a late host catch up
+    menu.setMirror(&Serial, 100);
+}
+
+void loop() {
+    menu.refreshDisplay();
+
+    static unsigned long lastReport = 0;
+    if (millis() - lastReport >= 10000) {
+        lastReport = millis();
+        // Text between the frames is skipped by the decoder
+        Serial.print(F("mirror bytes: "));
+        Serial.println(menu.getMirrorBytes());
+    }
+}
@@ -0,0 +1,44 @@
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuManager.h>
+
+// Two displays on the same I2C bus, the second one strapped to address 0x3D
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C leftDisplay(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C rightDisplay(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+StaticOledMenu<1> leftMenu(leftDisplay, 256, 500);
+StaticOledMenu<1> rightMenu(rightDisplay, 256, 500);
+
+// At most 2 ms of bus time per loop, the display that changed last is sent first
+StaticOledMenuManager<2> displays(2000);
+
+char leftBuffer[32];
+char rightBuffer[32];
+
+void uptimePage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Uptime\n%lu s\n", millis() / 1000) + 1;
+}
+
+void loopCountPage(MENU::structs::menuPageInfo *page_info) {
+    static uint32_t loops = 0;
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Loops\n%lu\n", static_cast<unsigned long>(++loops / 1000)) + 1;
+}
+
+void setup() {
+    rightDisplay.setI2CAddress(0x3D * 2);
+    leftMenu.init();
+    rightMenu.init();
+    leftMenu.setDirtyTileTracking(true);
+    rightMenu.setDirtyTileTracking(true);
+    leftMenu.addMenuPage(MENU::structs::USER, false, uptimePage, leftBuffer, sizeof(leftBuffer));
+    rightMenu.addMenuPage(MENU::structs::USER, false, loopCountPage, rightBuffer, sizeof(rightBuffer));
+    displays.addSurface(leftMenu);
+    displays.addSurface(rightMenu);
+}
+
+void loop() {
+    // Render both menus, then share the bus between them within the budget
+    displays.refreshDisplays();
+    displays.service();
+}
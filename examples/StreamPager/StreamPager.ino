@@ -0,0 +1,58 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+OledMenu menu(u8g2, 512, 500);
+
+// A 20000 line log that exists only as a reader, far larger than RAM. With a flash filesystem the reader
+// would be file.seek(offset) followed by file.readBytes(dest, length), with the File passed as context.
+const uint32_t logLines = 20000;
+
+uint16_t readLog(uint32_t offset, char *dest, uint16_t length, void *context) {
+    uint16_t copied = 0;
+    char line[24];
+    while (copied < length) {
+        uint32_t index = offset / 16;
+        if (index >= logLines) {
+            break;
+        }
+        // Every line is 16 characters: "#00042 t=  1260\n"
+        snprintf(line, sizeof(line), "#%05lu t=%6lu\n", static_cast<unsigned long>(index), static_cast<unsigned long>(index * 30));
+        uint16_t from = offset % 16;
+        uint16_t count = 16 - from;
+        if (count > length - copied) {
+            count = length - copied;
+        }
+        memcpy(dest + copied, line + from, count);
+        copied += count;
+        offset += count;
+    }
+    return copied;
+}
+
+// 32 checkpoints cover the whole log, a jump reads at most one checkpoint interval of lines
+uint32_t logCheckpoints[32];
+MENU::structs::streamDocument logDocument(readLog, nullptr, logCheckpoints, NELEMS(logCheckpoints));
+
+// Only the visible window is kept in RAM
+char logWindow[128];
+
+void setup() {
+    Serial.begin(115200);
+    menu.init();
+    menu.addStreamPage(true, &logDocument, logWindow, sizeof(logWindow));
+}
+
+void loop() {
+    // Scroll down a line every 100 ms, jump with "g<line>" on the serial port
+    static unsigned long lastScroll = 0;
+    if (millis() - lastScroll >= 100) {
+        lastScroll = millis();
+        menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+    }
+    if (Serial.available() && Serial.read() == 'g') {
+        logDocument.top_line = Serial.parseInt();
+    }
+    menu.refreshDisplay();
+}
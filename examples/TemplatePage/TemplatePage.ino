@@ -0,0 +1,36 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display, a full frame buffer lets fields be redrawn in place
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+// Values shown on the page, the menu reads them on every refresh
+char deviceName[] = "sensor-01";
+int32_t uptimeSeconds = 0;
+float temperature = 21.5f;
+uint32_t address = 0x0101A8C0; // 192.168.1.1, as IPAddress converts to uint32_t
+
+// One field for every "{}" of the layout, in layout order
+MENU::structs::templateField statusFields[] = {
+    {MENU::structs::STRING, deviceName, 10},
+    {MENU::structs::IP, &address, 15},
+    {MENU::structs::INT, &uptimeSeconds, 6},
+    {MENU::structs::FLOAT, &temperature, 5, 1},
+};
+
+char statusBuffer[64];
+
+OledMenu menu(u8g2, 512, 500);
+
+void setup() {
+    menu.init();
+    menu.setDirtyTileTracking(true);
+    menu.addTemplatePage(false, "{}\n{}\nUp {} s\nTemp {} C", statusFields, NELEMS(statusFields),
+                         statusBuffer, sizeof(statusBuffer));
+}
+
+void loop() {
+    // Only the fields that changed are formatted and drawn, the static text stays on the display
+    uptimeSeconds = millis() / 1000;
+    temperature = 21.5f + (uptimeSeconds % 10) / 10.0f;
+    menu.refreshDisplay();
+}
@@ -0,0 +1,51 @@
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+// Build with -DOLED_MENU_ENABLE_TRACE for the whole build, then save the serial output as trace.json
+// and open it in chrome://tracing or https://ui.perfetto.dev
+SimulatedDisplay display(MENU::sim::FULL_BUFFER, 400000);
+StaticOledMenu<2> menu(display, 512, 500);
+
+char statusBuffer[64];
+char settingsBuffer[64];
+
+void statusPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Status\nUptime %lu ms\n", millis()) + 1;
+}
+
+void settingsPage(MENU::structs::menuPageInfo *page_info) {
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Contrast\nTimeout\nUnits\nReset\n") + 1;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(100);
+#if defined(OLED_MENU_ENABLE_TRACE)
+    menu.init();
+    menu.addMenuPage(MENU::structs::USER, false, statusPage, statusBuffer, sizeof(statusBuffer));
+    menu.addMenuPage(MENU::structs::USER, true, settingsPage, settingsBuffer, sizeof(settingsBuffer));
+
+    // A short scripted session: idle frames, a page change, item moves and an enter/exit
+    for (int i = 0; i < 3; i++) {
+        menu.refreshDisplay();
+    }
+    menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE);
+    menu.refreshDisplay();
+    menu.postInput(MENU::structs::INPUT_EVENT::ENTER);
+    menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+    menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+    menu.refreshDisplay();
+    menu.postInput(MENU::structs::INPUT_EVENT::EXIT);
+    menu.postInput(MENU::structs::INPUT_EVENT::PREVIOUS_PAGE);
+    menu.refreshDisplay();
+
+    menu.writeChromeTrace(Serial);
+#else
+    Serial.println(F("Build with -DOLED_MENU_ENABLE_TRACE to record a trace"));
+#endif
+}
+
+void loop() {
+}
@@ -0,0 +1,31 @@
+#include <U8G2OledMenu.h>
+
+// Create an instance of the U8G2 display
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/U8X8_PIN_NONE);
+
+OledMenu menu(u8g2, 512, 500);
+
+char noteBuffer[160];
+
+// Wrapped rows of the last text, reused while its lines do not change
+MENU::structs::wrapCache wrapCache;
+
+void notePage(MENU::structs::menuPageInfo *page_info) {
+    // Only the last line changes, the wrapped rows of the first one are reused
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Long lines are wrapped at spaces to the display width, "
+                                            "measured with the real glyph widths of the font.\nUp %lu s",
+                                            millis() / 1000) + 1;
+}
+
+void setup() {
+    menu.init();
+    // Three lines per screen selects a proportional font, so wrapping by character count would be wrong
+    menu.setNumberOfDisplayLines(3);
+    menu.setWordWrap(&wrapCache);
+    menu.addMenuPage(MENU::structs::USER, true, notePage, noteBuffer, sizeof(noteBuffer));
+}
+
+void loop() {
+    menu.refreshDisplay();
+}
@@ -0,0 +1,108 @@
+// Writes the mirror stream of a short menu session to stdout, like setMirror(&Serial) on a board, and every
+// frame drawn to <reference dir>/ref_<n>.pbm, so the frames rebuilt by extras/mirror_decode.py can be checked:
+//
+//   build/mirror_producer refs/ | python3 extras/mirror_decode.py - frames/
+
+#include <Arduino.h>
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string>
+
+SimulatedDisplay display(MENU::sim::FULL_BUFFER, 400000);
+StaticOledMenu<2> menu(display, 512, 500);
+
+char statusBuffer[64];
+char listBuffer[64];
+int counter = 0;
+
+void statusPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size =
+        snprintf(page_info->buffer, page_info->target_buffer_size, "Status\nCount %d\n", counter) + 1;
+}
+
+void listPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Alpha\nBeta\nGamma\nDelta\n") + 1;
+}
+
+/// @brief Save the display buffer as a PBM image, the format mirror_decode.py writes
+bool writeReference(const std::string &path)
+{
+    FILE *image = fopen(path.c_str(), "wb");
+    if (image == nullptr)
+    {
+        return false;
+    }
+    const uint8_t *buffer = display.getBufferPtr();
+    uint16_t width = display.getBufferTileWidth() * 8;
+    uint16_t height = display.getBufferTileHeight() * 8;
+    fprintf(image, "P4\n%u %u\n", width, height);
+    for (uint16_t y = 0; y < height; y++)
+    {
+        for (uint16_t x0 = 0; x0 < width; x0 += 8)
+        {
+            uint8_t bits = 0;
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                // Vertical tiles: one byte is 8 pixels of a column, least significant bit on top
+                bits |= ((buffer[(y / 8) * width + x0 + bit] >> (y % 8)) & 1) << (7 - bit);
+            }
+            fputc(bits, image);
+        }
+    }
+    return fclose(image) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <reference dir>\n", argv[0]);
+        return 2;
+    }
+
+    menu.init();
+    menu.addMenuPage(MENU::structs::USER, false, statusPage, statusBuffer, sizeof(statusBuffer));
+    menu.addMenuPage(MENU::structs::USER, true, listPage, listBuffer, sizeof(listBuffer));
+    // A full frame every 8 frames, the other frames only carry the changed tiles
+    menu.setMirror(&Serial, 8);
+
+    for (int frame = 0; frame < 30; frame++)
+    {
+        counter = frame;
+        if (frame == 10)
+        {
+            menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE);
+        }
+        else if (frame == 12)
+        {
+            menu.postInput(MENU::structs::INPUT_EVENT::ENTER);
+        }
+        else if (frame == 14)
+        {
+            menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+        }
+        else if (frame == 16)
+        {
+            menu.postInput(MENU::structs::INPUT_EVENT::EXIT);
+            menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE);
+        }
+        else if (frame == 20)
+        {
+            // Sketch output between the frames, with a stray sync, is skipped by the decoder
+            Serial.print("counter \xA5\x5A reset\n");
+        }
+        menu.refreshDisplay();
+
+        char name[32];
+        snprintf(name, sizeof(name), "/ref_%05d.pbm", frame + 1);
+        if (!writeReference(argv[1] + std::string(name)))
+        {
+            fprintf(stderr, "cannot write %s%s\n", argv[1], name);
+            return 1;
+        }
+    }
+    Serial.flush();
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Runs an example sketch on the host: setup() once, then loop() OLED_MENU_SKETCH_LOOPS times.
+// OLED_MENU_SKETCH is the path of the .ino file, set by CMakeLists.txt.
+
+#include <Arduino.h>
+
+#ifndef OLED_MENU_SKETCH_LOOPS
+#define OLED_MENU_SKETCH_LOOPS 1
+#endif
+
+#include OLED_MENU_SKETCH
+
+int main()
+{
+    setup();
+    for (int i = 0; i < OLED_MENU_SKETCH_LOOPS; i++)
+    {
+        loop();
+    }
+    Serial.flush();
+    return 0;
+}
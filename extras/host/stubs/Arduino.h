@@ -0,0 +1,164 @@
+#ifndef OLED_MENU_HOST_ARDUINO_H
+#define OLED_MENU_HOST_ARDUINO_H
+
+// Minimal Arduino core for building the library and its sketches on a desktop machine.
+// Only what the library and the examples use is provided.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Flash access, flash and RAM are the same address space on the host
+#define PROGMEM
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+#define IRAM_ATTR
+
+#define DEC 10
+#define HEX 16
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define A0 0
+
+/// @brief Microseconds since start, plus the time skipped by delay()
+unsigned long micros();
+/// @brief Milliseconds since start, plus the time skipped by delay()
+unsigned long millis();
+/// @brief Advances the clock by ms without sleeping, so sketches that wait run at full speed
+void delay(unsigned long ms);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int analogRead(uint8_t) { return 512; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int, void (*)(), int) {}
+
+/// @brief Arduino Print, formats numbers and forwards the bytes to write()
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+        while (size--)
+        {
+            written += write(*buffer++);
+        }
+        return written;
+    }
+    size_t write(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const __FlashStringHelper *text) { return write(reinterpret_cast<const char *>(text)); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(unsigned long value, int base = DEC)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+        return write(text);
+    }
+    size_t print(long value, int base = DEC)
+    {
+        if (base != DEC)
+        {
+            return print(static_cast<unsigned long>(value), base);
+        }
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", value);
+        return write(text);
+    }
+    size_t print(unsigned int value, int base = DEC) { return print(static_cast<unsigned long>(value), base); }
+    size_t print(int value, int base = DEC) { return print(static_cast<long>(value), base); }
+    size_t print(unsigned char value, int base = DEC) { return print(static_cast<unsigned long>(value), base); }
+    size_t print(double value, int digits = 2)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*f", digits, value);
+        return write(text);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value)
+    {
+        size_t written = print(value);
+        return written + println();
+    }
+    template <typename T>
+    size_t println(T value, int format)
+    {
+        size_t written = print(value, format);
+        return written + println();
+    }
+};
+
+/// @brief Serial port on stdout, never has input
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    using Print::write;
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+    long parseInt() { return 0; }
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+/// @brief Format value with width and prec decimals into text, like the avr-libc function
+inline char *dtostrf(double value, signed char width, unsigned char prec, char *text)
+{
+    sprintf(text, "%*.*f", width, prec, value);
+    return text;
+}
+
+/// @brief Arduino String, only what the WiFi stubs need
+class String
+{
+public:
+    String(const char *text = "") : text(text) {}
+    const char *c_str() const { return text.c_str(); }
+    size_t length() const { return text.size(); }
+
+private:
+    std::string text;
+};
+
+#endif
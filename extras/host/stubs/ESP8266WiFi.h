@@ -0,0 +1,6 @@
+#ifndef OLED_MENU_HOST_ESP8266WIFI_H
+#define OLED_MENU_HOST_ESP8266WIFI_H
+
+#include <WiFi.h>
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef OLED_MENU_HOST_ESP8266MDNS_H
+#define OLED_MENU_HOST_ESP8266MDNS_H
+
+#endif
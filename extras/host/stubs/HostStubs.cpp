@@ -0,0 +1,41 @@
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <WiFi.h>
+#include <chrono>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+#define OLED_MENU_HOST_DEFINE_FONT(name, width, ascent, descent, proportional)                                         \
+    extern const uint8_t name[4] = {width, ascent, descent, proportional};
+OLED_MENU_HOST_FONTS(OLED_MENU_HOST_DEFINE_FONT)
+#undef OLED_MENU_HOST_DEFINE_FONT
+
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+static unsigned long delayed_micros = 0; // Time skipped by delay()
+
+unsigned long micros()
+{
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start_time;
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) +
+           delayed_micros;
+}
+
+unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+    delayed_micros += ms * 1000;
+}
+
+extern "C" void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *, u8g2_uint_t, u8g2_uint_t, u8g2_uint_t, uint8_t)
+{
+}
+
+extern "C" int8_t u8g2_GetGlyphWidth(u8g2_t *u8g2, uint16_t encoding)
+{
+    return u8g2_stub_glyph_advance(u8g2->font, encoding);
+}
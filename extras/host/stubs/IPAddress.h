@@ -0,0 +1,16 @@
+#ifndef OLED_MENU_HOST_IPADDRESS_H
+#define OLED_MENU_HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+/// @brief IPv4 address, the host stub always reports 192.168.0.2
+class IPAddress
+{
+public:
+    uint8_t operator[](int index) const { return octets[index]; }
+
+private:
+    uint8_t octets[4] = {192, 168, 0, 2};
+};
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef OLED_MENU_HOST_U8G2LIB_H
+#define OLED_MENU_HOST_U8G2LIB_H
+
+// Stand-in for U8g2 on the host: a 128x64 vertical_top_lsb frame buffer with the same buffer,
+// page and bus behaviour as the SSD1306 I2C drivers. Fonts only carry metrics; glyphs are drawn
+// as a fixed pattern per character, so frames are deterministic but do not look like text.
+
+#include <Arduino.h>
+
+typedef uint16_t u8g2_uint_t;
+
+struct u8x8_struct;
+typedef struct u8x8_struct u8x8_t;
+typedef uint8_t (*u8x8_msg_cb)(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+struct u8x8_struct
+{
+    void *user_ptr;
+};
+
+#define u8x8_SetUserPtr(u8x8, p) ((u8x8)->user_ptr = (p))
+#define u8x8_GetUserPtr(u8x8) ((u8x8)->user_ptr)
+
+#define U8X8_MSG_BYTE_SEND 23
+#define U8X8_MSG_BYTE_INIT 24
+#define U8X8_MSG_BYTE_SET_DC 25
+#define U8X8_MSG_BYTE_START_TRANSFER 26
+#define U8X8_MSG_BYTE_END_TRANSFER 27
+
+#define U8X8_PIN_NONE 255
+
+struct u8g2_struct;
+typedef struct u8g2_struct u8g2_t;
+typedef void (*u8g2_draw_ll_hvline_cb)(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+
+struct u8g2_struct
+{
+    u8x8_t u8x8;
+    u8x8_msg_cb byte_cb;
+    const uint8_t *font;
+    u8g2_draw_ll_hvline_cb ll_hvline;
+    uint8_t *tile_buf_ptr;
+    uint8_t tile_buf_height;
+    uint8_t tile_curr_row;
+};
+
+struct u8g2_cb_struct;
+typedef struct u8g2_cb_struct u8g2_cb_t;
+#define U8G2_R0 (static_cast<const u8g2_cb_t *>(nullptr))
+
+extern "C"
+{
+    void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+    int8_t u8g2_GetGlyphWidth(u8g2_t *u8g2, uint16_t encoding);
+}
+
+// Stub fonts are {max width, ascent, descent, proportional}
+#define OLED_MENU_HOST_FONTS(FONT)                                                                                     \
+    FONT(u8g2_font_3x3basic_tr, 3, 3, 0, 0)                                                                            \
+    FONT(u8g2_font_u8glib_4_tr, 4, 4, 0, 0)                                                                            \
+    FONT(u8g2_font_tiny5_tr, 4, 5, 0, 1)                                                                               \
+    FONT(u8g2_font_5x7_tr, 5, 6, 1, 0)                                                                                 \
+    FONT(u8g2_font_6x10_tr, 6, 8, 2, 0)                                                                                \
+    FONT(u8g2_font_t0_11_tr, 6, 9, 2, 0)                                                                               \
+    FONT(u8g2_font_6x13_tr, 6, 10, 3, 0)                                                                               \
+    FONT(u8g2_font_7x14_tr, 7, 11, 3, 0)                                                                               \
+    FONT(u8g2_font_t0_17_tr, 9, 14, 3, 0)                                                                              \
+    FONT(u8g2_font_helvR12_tr, 11, 12, 3, 1)                                                                           \
+    FONT(u8g2_font_10x20_tf, 10, 15, 5, 0)                                                                             \
+    FONT(u8g2_font_profont22_tr, 12, 17, 5, 0)                                                                         \
+    FONT(u8g2_font_courB18_tr, 14, 15, 6, 0)                                                                           \
+    FONT(u8g2_font_crox5t_tr, 13, 17, 4, 1)                                                                            \
+    FONT(u8g2_font_crox5h_tr, 13, 17, 5, 1)                                                                            \
+    FONT(u8g2_font_ncenR18_tr, 16, 18, 5, 1)                                                                           \
+    FONT(u8g2_font_courR24_tr, 15, 18, 6, 0)                                                                           \
+    FONT(u8g2_font_fur20_tr, 17, 20, 4, 1)                                                                             \
+    FONT(u8g2_font_osr21_tr, 18, 22, 5, 1)                                                                             \
+    FONT(u8g2_font_logisoso22_tr, 12, 22, 0, 1)                                                                        \
+    FONT(u8g2_font_timR24_tr, 18, 20, 6, 1)                                                                            \
+    FONT(u8g2_font_helvB08_tf, 6, 8, 2, 1)
+
+#define OLED_MENU_HOST_DECLARE_FONT(name, width, ascent, descent, proportional) extern const uint8_t name[4];
+OLED_MENU_HOST_FONTS(OLED_MENU_HOST_DECLARE_FONT)
+#undef OLED_MENU_HOST_DECLARE_FONT
+
+/// @brief Advance of a character in a stub font, proportional fonts vary it by character
+inline int8_t u8g2_stub_glyph_advance(const uint8_t *font, uint16_t encoding)
+{
+    if (font == nullptr)
+    {
+        return 0;
+    }
+    return font[3] ? static_cast<int8_t>(font[0] - 2 + encoding % 3) : static_cast<int8_t>(font[0]);
+}
+
+/// @brief Host U8G2 with a 128x64 vertical_top_lsb buffer of tile_rows tile rows
+class U8G2 : public Print
+{
+public:
+    U8G2(uint8_t tile_rows = 8)
+    {
+        memset(&u8g2, 0, sizeof(u8g2));
+        memset(buffer, 0, sizeof(buffer));
+        u8g2.ll_hvline = u8g2_ll_hvline_vertical_top_lsb;
+        u8g2.tile_buf_ptr = buffer;
+        u8g2.tile_buf_height = tile_rows;
+    }
+
+    bool begin() { return true; }
+    u8g2_t *getU8g2() { return &u8g2; }
+    u8x8_t *getU8x8() { return &u8g2.u8x8; }
+    void setI2CAddress(uint8_t) {}
+
+    uint8_t *getBufferPtr() { return buffer; }
+    uint8_t getBufferTileHeight() { return u8g2.tile_buf_height; }
+    uint8_t getBufferTileWidth() { return width / 8; }
+    uint8_t getBufferCurrTileRow() { return u8g2.tile_curr_row; }
+    void setBufferCurrTileRow(uint8_t row) { u8g2.tile_curr_row = row; }
+    u8g2_uint_t getDisplayWidth() { return width; }
+    u8g2_uint_t getDisplayHeight() { return height; }
+
+    void clearBuffer() { memset(buffer, 0, static_cast<size_t>(u8g2.tile_buf_height) * width); }
+    void sendBuffer() { send(static_cast<size_t>(u8g2.tile_buf_height) * width); }
+    void updateDisplayArea(uint8_t, uint8_t, uint8_t tile_width, uint8_t tile_height)
+    {
+        send(static_cast<size_t>(tile_width) * tile_height * 8);
+    }
+    void firstPage()
+    {
+        u8g2.tile_curr_row = 0;
+        clearBuffer();
+    }
+    uint8_t nextPage()
+    {
+        sendBuffer();
+        u8g2.tile_curr_row += u8g2.tile_buf_height;
+        if (u8g2.tile_curr_row >= height / 8)
+        {
+            return 0;
+        }
+        clearBuffer();
+        return 1;
+    }
+    void clearDisplay() {}
+
+    void setPowerSave(uint8_t is_enable) { power_save = is_enable; }
+    void setContrast(uint8_t value) { contrast = value; }
+    /// @brief Last power save mode set, for tests
+    uint8_t getPowerSave() const { return power_save; }
+    /// @brief Last contrast set, the value of the SSD1306 init sequence until then, for tests
+    uint8_t getContrast() const { return contrast; }
+
+    void setFont(const uint8_t *font) { u8g2.font = font; }
+    void setFontMode(uint8_t) {}
+    void setFontRefHeightExtendedText() {}
+    void enableUTF8Print() {}
+    void setDrawColor(uint8_t color) { draw_color = color; }
+    int8_t getMaxCharHeight() { return u8g2.font ? u8g2.font[1] + u8g2.font[2] : 0; }
+    int8_t getMaxCharWidth() { return u8g2.font ? u8g2.font[0] : 0; }
+    int8_t getAscent() { return u8g2.font ? u8g2.font[1] : 0; }
+    int8_t getDescent() { return u8g2.font ? -u8g2.font[2] : 0; }
+    u8g2_uint_t getStrWidth(const char *text)
+    {
+        u8g2_uint_t text_width = 0;
+        while (*text)
+        {
+            text_width += u8g2_stub_glyph_advance(u8g2.font, static_cast<uint8_t>(*text++));
+        }
+        return text_width;
+    }
+
+    void drawPixel(int x, int y)
+    {
+        int row = y - u8g2.tile_curr_row * 8;
+        if (x < 0 || x >= width || row < 0 || row >= u8g2.tile_buf_height * 8)
+        {
+            return;
+        }
+        uint8_t *tile_byte = &buffer[(row / 8) * width + x];
+        uint8_t mask = 1 << (row & 7);
+        if (draw_color == 1)
+        {
+            *tile_byte |= mask;
+        }
+        else if (draw_color == 0)
+        {
+            *tile_byte &= ~mask;
+        }
+        else
+        {
+            *tile_byte ^= mask;
+        }
+    }
+    void drawBox(int x, int y, int box_width, int box_height)
+    {
+        for (int j = 0; j < box_height; j++)
+        {
+            for (int i = 0; i < box_width; i++)
+            {
+                drawPixel(x + i, y + j);
+            }
+        }
+    }
+    void drawVLine(int x, int y, int length) { drawBox(x, y, 1, length); }
+    void drawHLine(int x, int y, int length) { drawBox(x, y, length, 1); }
+    u8g2_uint_t drawStr(int x, int y, const char *text)
+    {
+        u8g2_uint_t advance = 0;
+        int ascent = getAscent();
+        while (*text)
+        {
+            uint8_t c = *text++;
+            int glyph_width = u8g2_stub_glyph_advance(u8g2.font, c);
+            for (int i = 0; i < glyph_width - 1; i++)
+            {
+                for (int j = 0; j < ascent; j++)
+                {
+                    if ((c * 7 + i * 3 + j) % 5 == 0)
+                    {
+                        drawPixel(x + advance + i, y - ascent + j);
+                    }
+                }
+            }
+            advance += glyph_width;
+        }
+        return advance;
+    }
+    size_t write(uint8_t) override { return 1; }
+
+protected:
+    u8g2_t u8g2;
+
+private:
+    static const uint8_t width = 128;
+    static const uint8_t height = 64;
+    uint8_t buffer[width * height / 8];
+    uint8_t draw_color = 1;
+    uint8_t power_save = 0;
+    uint8_t contrast = 0xCF;
+
+    /// @brief Hand size bytes to the byte callback in transfers of up to 32 bytes, like the I2C driver
+    void send(size_t size)
+    {
+        if (u8g2.byte_cb == nullptr)
+        {
+            return;
+        }
+        while (size > 0)
+        {
+            uint8_t chunk = size > 32 ? 32 : static_cast<uint8_t>(size);
+            u8g2.byte_cb(&u8g2.u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, nullptr);
+            u8g2.byte_cb(&u8g2.u8x8, U8X8_MSG_BYTE_SEND, chunk, buffer);
+            u8g2.byte_cb(&u8g2.u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, nullptr);
+            size -= chunk;
+        }
+    }
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2
+{
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t *, uint8_t = U8X8_PIN_NONE, uint8_t = U8X8_PIN_NONE,
+                                        uint8_t = U8X8_PIN_NONE)
+        : U8G2(8)
+    {
+    }
+};
+
+class U8G2_SSD1306_128X64_NONAME_1_HW_I2C : public U8G2
+{
+public:
+    U8G2_SSD1306_128X64_NONAME_1_HW_I2C(const u8g2_cb_t *, uint8_t = U8X8_PIN_NONE, uint8_t = U8X8_PIN_NONE,
+                                        uint8_t = U8X8_PIN_NONE)
+        : U8G2(1)
+    {
+    }
+};
+
+/// @brief Shared part of the u8g2_Setup_ssd1306_i2c_128x64_noname_* functions
+inline void u8g2_stub_setup(u8g2_t *u8g2, u8x8_msg_cb byte_cb, uint8_t tile_rows)
+{
+    u8g2->byte_cb = byte_cb;
+    u8g2->tile_buf_height = tile_rows;
+}
+
+#define u8g2_Setup_ssd1306_i2c_128x64_noname_f(u8g2, rotation, byte_cb, gpio_cb) u8g2_stub_setup(u8g2, byte_cb, 8)
+#define u8g2_Setup_ssd1306_i2c_128x64_noname_1(u8g2, rotation, byte_cb, gpio_cb) u8g2_stub_setup(u8g2, byte_cb, 1)
+#define u8g2_Setup_ssd1306_i2c_128x64_noname_2(u8g2, rotation, byte_cb, gpio_cb) u8g2_stub_setup(u8g2, byte_cb, 2)
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef OLED_MENU_HOST_WIFI_H
+#define OLED_MENU_HOST_WIFI_H
+
+// Connected station with fixed values, enough to build the connection info page with ESP32 defined
+
+#include <IPAddress.h>
+
+class WiFiClass
+{
+public:
+    IPAddress localIP() { return IPAddress(); }
+    String SSID() { return String("host"); }
+    int32_t RSSI() { return -60; }
+    const char *getHostname() { return "oled-menu-host"; }
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,55 @@
+// Asynchronous flushes record one FLUSH sample per frame, however many service() calls send it
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+static int counter = 0;
+
+static void counterPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Count\n%d\n", counter) + 1;
+}
+
+static uint32_t flushSamples(OledMenu &menu)
+{
+    return menu.getRenderStats().stages[MENU::structs::RENDER_STAGE::FLUSH].count;
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    static char page_buffer[32];
+    StaticOledMenu<1, 1, 1024> menu(display, 500);
+    menu.init();
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, counterPage, page_buffer, sizeof(page_buffer)));
+    CHECK(menu.setAsyncFlush(true, 1));
+    menu.resetRenderStats();
+
+    counter = 1;
+    menu.refreshDisplay();
+    uint8_t slices = 0;
+    while (menu.isFlushInProgress())
+    {
+        CHECK(flushSamples(menu) == 0);
+        CHECK(menu.service() == 1);
+        slices++;
+    }
+    CHECK(slices == display.getBufferTileHeight());
+    CHECK(flushSamples(menu) == 1);
+    CHECK(menu.service() == 0);
+    CHECK(flushSamples(menu) == 1);
+
+    // A frame replacing one in flight still ends in a single sample
+    counter = 2;
+    menu.refreshDisplay();
+    menu.service();
+    counter = 3;
+    menu.refreshDisplay();
+    while (menu.service() > 0)
+    {
+    }
+    CHECK(menu.getFramesCoalesced() == 1);
+    CHECK(flushSamples(menu) == 2);
+    return 0;
+}
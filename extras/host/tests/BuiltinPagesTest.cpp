@@ -0,0 +1,65 @@
+// The built-in pages stay inside their buffer and report the size they need, built with ESP32 for the WiFi page
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <string.h>
+
+static MENU::structs::menuPageInfo makePage(MENU::structs::menu_callback callback, char *buffer, uint16_t size)
+{
+    return MENU::structs::menuPageInfo(MENU::structs::USER, false, callback, buffer, size);
+}
+
+int main()
+{
+    char buffer[64];
+
+    // The WiFi stub reports "host", 192.168.0.2, -60 dBm and "oled-menu-host"
+    const char *connection = "host\n192.168.0.2\nRSSI: -60\noled-menu-host\n";
+    MENU::structs::menuPageInfo page = makePage(MENU::builtin_pages::connectionInfo, buffer, sizeof(buffer));
+    MENU::builtin_pages::connectionInfo(&page);
+    CHECK(strcmp(buffer, connection) == 0);
+    CHECK(page.needs_buffer_size == strlen(connection) + 1);
+
+    // A short buffer is cut, not overrun, and the page asks for a larger one
+    memset(buffer, '#', sizeof(buffer));
+    page = makePage(MENU::builtin_pages::connectionInfo, buffer, 16);
+    MENU::builtin_pages::connectionInfo(&page);
+    CHECK(strlen(buffer) == 15);
+    CHECK(strncmp(buffer, connection, 15) == 0);
+    CHECK(buffer[16] == '#');
+    CHECK(page.needs_buffer_size == strlen(connection) + 1);
+
+    uint8_t parameters[2] = {42, 100};
+    page = makePage(MENU::builtin_pages::OTAInfo, buffer, sizeof(buffer));
+    page.parameters = parameters;
+    MENU::builtin_pages::OTAInfo(&page);
+    CHECK(strstr(buffer, "\nProgress: 42%\n") != nullptr);
+    CHECK(page.needs_buffer_size == strlen(buffer) + 1);
+
+    // Totals below 100 do not divide by zero
+    parameters[0] = 5;
+    parameters[1] = 50;
+    MENU::builtin_pages::OTAInfo(&page);
+    CHECK(strstr(buffer, "\nProgress: 10%\n") != nullptr);
+
+    parameters[0] = 0;
+    parameters[1] = 0;
+    MENU::builtin_pages::OTAInfo(&page);
+    CHECK(strstr(buffer, "\nProgress: 0%\n") != nullptr);
+
+    parameters[0] = 200;
+    parameters[1] = 200;
+    MENU::builtin_pages::OTAInfo(&page);
+    CHECK(strstr(buffer, "\nProgress: 100%\nUpdate Complete.Restarting...") != nullptr);
+    uint16_t needed = page.needs_buffer_size;
+    CHECK(needed == strlen(buffer) + 1);
+
+    memset(buffer, '#', sizeof(buffer));
+    page = makePage(MENU::builtin_pages::OTAInfo, buffer, 20);
+    page.parameters = parameters;
+    MENU::builtin_pages::OTAInfo(&page);
+    CHECK(strlen(buffer) == 19);
+    CHECK(buffer[20] == '#');
+    CHECK(page.needs_buffer_size == needed);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Error records: string arguments are copied and compared by content, long specifications and wide characters are
+// rejected
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string.h>
+#include <string>
+#include <wchar.h>
+
+static void statusPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Status\n") + 1;
+}
+
+static const char *shownError(OledMenu &menu)
+{
+    menu.refreshDisplay();
+    return menu.error_buffer_;
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    static char page_buffer[32];
+    StaticOledMenu<1, 1, 1024> menu(display, 500);
+    menu.init();
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, statusPage, page_buffer, sizeof(page_buffer)));
+
+    // The caller's buffer is reused before the error is shown
+    char name[16];
+    strcpy(name, "left");
+    CHECK(menu.showErrorMessage("Sensor %s offline", name) == 1);
+    strcpy(name, "right");
+    CHECK(strcmp(shownError(menu), "Sensor left offline") == 0);
+
+    // Same text in another buffer is a repeat, other text in the same buffer is not
+    char same[16];
+    strcpy(same, "left");
+    CHECK(menu.showErrorMessage("Sensor %s offline", same) == 2);
+    CHECK(strcmp(shownError(menu), "Sensor left offline x2") == 0);
+    CHECK(menu.showErrorMessage("Sensor %s offline", name) == 1);
+    menu.acknowledgeError();
+    CHECK(strcmp(shownError(menu), "Sensor right offline") == 0);
+    menu.acknowledgeError();
+
+    // Strings share OLED_MENU_ERROR_TEXT_SIZE bytes, later ones are cut first
+    char long_text[OLED_MENU_ERROR_TEXT_SIZE * 2];
+    memset(long_text, 'a', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = '\0';
+    CHECK(menu.showErrorMessage("%s|%s|%-4d", long_text, "b", 7) == 1);
+    std::string expected = std::string(OLED_MENU_ERROR_TEXT_SIZE - 1, 'a') + "||7   ";
+    CHECK(expected == shownError(menu));
+    menu.acknowledgeError();
+
+    // Specifications that do not fit the rebuilt specification buffer are rejected, not cut
+    CHECK(menu.showErrorMessage("%-*.*ld", 4, 2, 7L) == 1);
+    CHECK(strcmp(shownError(menu), "07  ") == 0);
+    menu.acknowledgeError();
+    char spec[OLED_MENU_ERROR_SPEC_SIZE + 2] = "%";
+    memset(spec + 1, '-', OLED_MENU_ERROR_SPEC_SIZE - 1);
+    spec[OLED_MENU_ERROR_SPEC_SIZE] = 'd';
+    CHECK(menu.showErrorMessage(spec, 1) == -1);
+    spec[OLED_MENU_ERROR_SPEC_SIZE - 2] = 'd';
+    spec[OLED_MENU_ERROR_SPEC_SIZE - 1] = '\0';
+    CHECK(menu.showErrorMessage(spec, 1) == 1);
+    CHECK(strcmp(shownError(menu), "1") == 0);
+    menu.acknowledgeError();
+
+    // Wide characters and strings are rejected, only their size modifier tells them apart
+    CHECK(menu.showErrorMessage("Key %lc", static_cast<wint_t>('k')) == -1);
+    CHECK(menu.showErrorMessage("Name %ls", L"wide") == -1);
+    CHECK(menu.showErrorMessage("Key %hc", 'k') == -1);
+    CHECK(menu.showErrorMessage("Key %c", 'k') == 1);
+    CHECK(strcmp(shownError(menu), "Key k") == 0);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// Text arena: aligned allocations whatever the address of the arena, and frame text that does not overwrite the
+// setText() copy
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <cstring>
+
+/// @brief Check that a pointer is 4-byte aligned
+static bool aligned(const void *ptr)
+{
+    return (reinterpret_cast<uintptr_t>(ptr) & 3) == 0;
+}
+
+int main()
+{
+    // A quarter of 500 bytes each for the error and page buffers puts the arena at offset 250
+    SimulatedDisplay display;
+    StaticOledMenu<1> menu(display, 500, 500);
+    menu.init();
+
+    char *first = menu.allocateFrameText(1);
+    char *second = menu.allocateFrameText(5);
+    char *third = menu.allocateFrameText(3);
+    CHECK(first != nullptr && second != nullptr && third != nullptr);
+    CHECK(aligned(first));
+    CHECK(aligned(second));
+    CHECK(aligned(third));
+    CHECK(second >= first + 1);
+    CHECK(third >= second + 5);
+
+    // Frame text of the following frames is allocated after the setText() copy
+    SimulatedDisplay reference_display;
+    StaticOledMenu<1> reference(reference_display, 500, 500);
+    reference.init();
+    reference.setText("Kept text\n");
+    menu.setText("Kept text\n");
+    for (int frame = 0; frame < 3; frame++)
+    {
+        menu.refreshDisplay();
+        char *frame_text = menu.allocateFrameText(32);
+        CHECK(frame_text != nullptr);
+        CHECK(aligned(frame_text));
+        memset(frame_text, 'x', 32);
+    }
+    menu.invalidateDisplay();
+    menu.refreshDisplay();
+    reference.refreshDisplay();
+    CHECK(memcmp(display.getBufferPtr(), reference_display.getBufferPtr(), display.getFrameBufferSize()) == 0);
+
+    // The arena at offset 250 of a malloc() buffer loses its first two bytes to the alignment
+    menu.clearDisplayBuffer();
+    CHECK(menu.allocateFrameText(248) != nullptr);
+    CHECK(menu.allocateFrameText(1) == nullptr);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Runs examples/GoldenImages against the golden table and the frames in extras/host/golden, fails if any
+// scenario failed. A frame that differs is written as <scenario>.actual.pbm to the working directory.
+// With OLED_MENU_HOST_RECORD_GOLDEN the sketch prints a new table and the frames are written to golden/.
+
+#include <Arduino.h>
+#include <string>
+
+#include OLED_MENU_SKETCH
+
+/// @brief Encode the frame buffer as a PBM image, the format of extras/mirror_decode.py
+static std::string encodeFrame()
+{
+    const uint8_t *frame = display.getBufferPtr();
+    uint16_t width = display.getDisplayWidth();
+    uint16_t height = display.getDisplayHeight();
+    std::string image = "P4\n" + std::to_string(width) + " " + std::to_string(height) + "\n";
+    for (uint16_t y = 0; y < height; y++)
+    {
+        for (uint16_t x0 = 0; x0 < width; x0 += 8)
+        {
+            uint8_t bits = 0;
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                // Vertical tiles: one byte is 8 pixels of a column, least significant bit on top
+                bits |= ((frame[(y / 8) * width + x0 + bit] >> (y % 8)) & 1) << (7 - bit);
+            }
+            image += static_cast<char>(bits);
+        }
+    }
+    return image;
+}
+
+static bool writeFile(const std::string &path, const std::string &data)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
+
+bool checkHostFrame(const char *name)
+{
+    std::string golden_path = std::string(OLED_MENU_GOLDEN_DIR "/") + name + ".pbm";
+    std::string image = encodeFrame();
+#if defined(RECORD_GOLDEN)
+    if (!writeFile(golden_path, image))
+    {
+        fprintf(stderr, "cannot write %s\n", golden_path.c_str());
+        goldenFailures++;
+        return false;
+    }
+    return true;
+#else
+    std::string golden;
+    FILE *file = fopen(golden_path.c_str(), "rb");
+    if (file != nullptr)
+    {
+        char chunk[512];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            golden.append(chunk, n);
+        }
+        fclose(file);
+    }
+    if (golden == image)
+    {
+        return true;
+    }
+    std::string actual_path = std::string(name) + ".actual.pbm";
+    writeFile(actual_path, image);
+    Serial.print(F("  frame differs from "));
+    Serial.print(golden_path.c_str());
+    Serial.print(F(", drawn frame in "));
+    Serial.println(actual_path.c_str());
+    return false;
+#endif
+}
+
+int main()
+{
+    setup();
+    Serial.flush();
+    return goldenFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#ifndef OLED_MENU_HOST_TEST_H
+#define OLED_MENU_HOST_TEST_H
+
+// Minimal checks for the host tests: a failed CHECK prints the condition and the test exits with 1
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(condition)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(condition))                                                                                              \
+        {                                                                                                              \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                              \
+            exit(1);                                                                                                   \
+        }                                                                                                              \
+    } while (0)
+
+#endif
@@ -0,0 +1,74 @@
+// The idle policy only writes the contrast to dim and to leave the dim level, unless it has an awake level
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+static void statusPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Status\n") + 1;
+}
+
+/// @brief Let the display idle for ms and refresh it
+static void idle(OledMenu &menu, unsigned long ms)
+{
+    delay(ms);
+    menu.refreshDisplay();
+}
+
+/// @brief Count as activity and refresh the display
+static void wake(OledMenu &menu)
+{
+    menu.wakeDisplay();
+    menu.refreshDisplay();
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    static char page_buffer[32];
+    StaticOledMenu<1> menu(display, 512, 500);
+    menu.init();
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, statusPage, page_buffer, sizeof(page_buffer)));
+    menu.refreshDisplay();
+
+    // The contrast of the sketch survives sleeping and waking
+    display.setContrast(0x40);
+    CHECK(menu.setIdlePolicy(0, 1000));
+    idle(menu, 1500);
+    CHECK(menu.getPowerState() == MENU::structs::ASLEEP);
+    CHECK(display.getPowerSave() == 1);
+    wake(menu);
+    CHECK(menu.getPowerState() == MENU::structs::AWAKE);
+    CHECK(display.getPowerSave() == 0);
+    CHECK(display.getContrast() == 0x40);
+
+    // Without an awake level, leaving the dim level restores the default contrast, also through sleep
+    CHECK(menu.setIdlePolicy(1000, 3000, 5));
+    CHECK(display.getContrast() == 0x40);
+    idle(menu, 1500);
+    CHECK(menu.getPowerState() == MENU::structs::DIMMED);
+    CHECK(display.getContrast() == 5);
+    wake(menu);
+    CHECK(display.getContrast() == OLED_MENU_DEFAULT_CONTRAST);
+    idle(menu, 1500);
+    idle(menu, 2000);
+    CHECK(menu.getPowerState() == MENU::structs::ASLEEP);
+    CHECK(display.getContrast() == 5);
+    wake(menu);
+    CHECK(display.getPowerSave() == 0);
+    CHECK(display.getContrast() == OLED_MENU_DEFAULT_CONTRAST);
+
+    // An awake level is set on every wake
+    CHECK(menu.setIdlePolicy(1000, 3000, 5, 0x80));
+    idle(menu, 1500);
+    CHECK(display.getContrast() == 5);
+    wake(menu);
+    CHECK(display.getContrast() == 0x80);
+    display.setContrast(0x10);
+    idle(menu, 3500);
+    CHECK(menu.getPowerState() == MENU::structs::ASLEEP);
+    wake(menu);
+    CHECK(display.getContrast() == 0x80);
+    return 0;
+}
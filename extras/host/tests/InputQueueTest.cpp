@@ -0,0 +1,54 @@
+// Input events queued by postInput() make the next refresh due, whatever the page and power state schedule
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+
+static void statusPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Status\n") + 1;
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    static char page_buffers[2][32];
+    StaticOledMenu<2> menu(display, 512, 500);
+    menu.init();
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, statusPage, page_buffers[0], sizeof(page_buffers[0])));
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, statusPage, page_buffers[1], sizeof(page_buffers[1])));
+    CHECK(menu.setPageRefreshPolicy(0, MENU::structs::ON_DEMAND));
+    CHECK(menu.setPageRefreshPolicy(1, MENU::structs::ON_DEMAND));
+    menu.refreshDisplay();
+    CHECK(menu.getNextRefreshDeadline() == OLED_MENU_NO_DEADLINE);
+
+    // Awake without an idle policy
+    CHECK(menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE));
+    CHECK(menu.getNextRefreshDeadline() == 0);
+    menu.refreshDisplay();
+    CHECK(menu.getNextRefreshDeadline() == OLED_MENU_NO_DEADLINE);
+
+    // Awake and dimmed with an idle policy that only has far away steps
+    CHECK(menu.setIdlePolicy(10000, 60000));
+    CHECK(menu.getNextRefreshDeadline() == 10000);
+    CHECK(menu.postInput(MENU::structs::INPUT_EVENT::PREVIOUS_PAGE));
+    CHECK(menu.getNextRefreshDeadline() == 0);
+    menu.refreshDisplay();
+    delay(15000);
+    menu.refreshDisplay();
+    CHECK(menu.getPowerState() == MENU::structs::DIMMED);
+    CHECK(menu.getNextRefreshDeadline() > 0);
+    CHECK(menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE));
+    CHECK(menu.getNextRefreshDeadline() == 0);
+    menu.refreshDisplay();
+    CHECK(menu.getPowerState() == MENU::structs::AWAKE);
+
+    // Asleep
+    delay(61000);
+    menu.refreshDisplay();
+    CHECK(menu.getPowerState() == MENU::structs::ASLEEP);
+    CHECK(menu.getNextRefreshDeadline() == OLED_MENU_NO_DEADLINE);
+    CHECK(menu.postInput(MENU::structs::INPUT_EVENT::PREVIOUS_PAGE));
+    CHECK(menu.getNextRefreshDeadline() == 0);
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Lines past OLED_MENU_MAX_LINES and characters past OLED_MENU_MAX_LINE_CHARS are not shown, but counted
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string>
+
+static std::string pageText;
+
+static void textPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "%s", pageText.c_str()) + 1;
+}
+
+static std::string makeText(int lines, int long_lines, bool trailing_newline)
+{
+    std::string text;
+    for (int i = 0; i < lines; i++)
+    {
+        text += std::string(i < long_lines ? OLED_MENU_MAX_LINE_CHARS + 10 : 10, 'a' + i % 26);
+        if (trailing_newline || i + 1 < lines)
+        {
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    static char page_buffer[4096];
+    StaticOledMenu<1> menu(display, 1024, 500);
+    menu.init();
+
+    pageText = makeText(OLED_MENU_MAX_LINES, 0, true);
+    CHECK(menu.addMenuPage(MENU::structs::USER, true, textPage, page_buffer, sizeof(page_buffer)));
+    menu.refreshDisplay();
+    CHECK(menu.getLinesDropped() == 0);
+    CHECK(menu.getLinesCut() == 0);
+
+    pageText = makeText(OLED_MENU_MAX_LINES + 5, 3, false);
+    menu.requestPageRefresh(0);
+    menu.refreshDisplay();
+    CHECK(menu.getLinesDropped() == 5);
+    CHECK(menu.getLinesCut() == 3);
+
+    // Wrapped rows count against the index, a text line that does not fit is dropped as a whole
+    static MENU::structs::wrapCache wrapCache;
+    CHECK(menu.setWordWrap(&wrapCache));
+    pageText = makeText(OLED_MENU_MAX_LINES, OLED_MENU_MAX_LINES, true);
+    menu.requestPageRefresh(0);
+    menu.refreshDisplay();
+    CHECK(menu.getLinesDropped() > 0);
+    CHECK(menu.getLinesCut() == 0);
+
+    pageText = makeText(2, 0, true);
+    menu.requestPageRefresh(0);
+    menu.refreshDisplay();
+    CHECK(menu.getLinesDropped() == 0);
+    return 0;
+}
@@ -0,0 +1,48 @@
+// A log page scrolled back keeps its lines in view while new lines are appended, until they leave the ring
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string.h>
+
+int main()
+{
+    SimulatedDisplay display;
+    StaticOledMenu<1> menu(display, 512, 500);
+    menu.init();
+    static char lines[8 * 16];
+    MENU::structs::logPage log(lines, 8, 16);
+    static char window[96];
+    CHECK(menu.addLogPage(true, &log, window, sizeof(window)));
+
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(OledMenu::appendLog(&log, "line %d", i));
+    }
+    menu.refreshDisplay();
+    menu.moveUpMenuItem();
+    menu.refreshDisplay();
+    CHECK(log.scrollback == 1);
+    CHECK(strncmp(window, "line 3\n", 7) == 0);
+
+    // The lines in view move back with each append, the oldest line of the ring stays the limit
+    CHECK(OledMenu::appendLog(&log, "line 8"));
+    CHECK(log.scrollback == 2);
+    for (int i = 9; i < 1000; i++)
+    {
+        CHECK(OledMenu::appendLog(&log, "line %d", i));
+        CHECK(log.scrollback <= log.count);
+    }
+    menu.refreshDisplay();
+    CHECK(strncmp(window, "line 992\n", 9) == 0);
+
+    // Scrolling forward from the oldest lines reaches the tail
+    for (int i = 0; i < 8; i++)
+    {
+        menu.moveDownMenuItem();
+    }
+    menu.refreshDisplay();
+    CHECK(log.scrollback == 0);
+    CHECK(strstr(window, "line 999") != nullptr);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Menu tables: compile time checks of long static text, no allocation at startup and line navigation before
+// the first render
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <new>
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *memory = malloc(size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+#define TEXT_10 "line text\n"
+#define TEXT_100 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10 TEXT_10
+#define TEXT_1000 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100 TEXT_100
+
+// Longer than the usual constexpr recursion limit of 512 calls for a check per character
+constexpr char longText[] PROGMEM = TEXT_1000 TEXT_1000;
+static_assert(MENU::table::textFits(longText, sizeof(longText)), "text fits its exact size");
+static_assert(!MENU::table::textFits(longText, sizeof(longText) - 1), "terminator does not fit");
+static_assert(MENU::table::textFits("", 1) && !MENU::table::textFits("", 0), "empty text");
+
+constexpr char aboutText[] PROGMEM = "First\nSecond line\nThird\n";
+
+static void countPage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, "Count\n") + 1;
+}
+
+constexpr MENU::structs::menuPageDef menuTable[] PROGMEM = {
+    {MENU::structs::USER, true, nullptr, aboutText, 32},
+    {MENU::structs::USER, false, countPage, nullptr, 16},
+    {MENU::structs::USER, false, nullptr, longText, sizeof(longText)},
+};
+
+OLED_MENU_TABLE_BUFFERS(menuTable, menuBuffers);
+
+int main()
+{
+    SimulatedDisplay display;
+    allocations = 0;
+    StaticOledMenu<NELEMS(menuTable), 1, 512> menu(display, 500);
+    CHECK(menu.loadMenuTable(menuTable, NELEMS(menuTable), menuBuffers, sizeof(menuBuffers)));
+    CHECK(allocations == 0);
+
+    CHECK(menu.pages[0].num_lines == 3);
+    CHECK(menu.pages[0].max_chars_on_line == 11);
+    CHECK(menu.pages[1].num_lines == 0); // Callback pages are indexed on their first render
+    CHECK(menu.pages[2].num_lines == OLED_MENU_MAX_LINES);
+    CHECK(menu.getMemoryFootprint().display_buffer == 512);
+
+    // Items move within the static text and wrap around at its last line
+    menu.init();
+    menu.moveDownMenuItem();
+    menu.moveDownMenuItem();
+    CHECK(menu.pages[0].page_line == 2);
+    menu.moveDownMenuItem();
+    CHECK(menu.pages[0].page_line == 0);
+    return 0;
+}
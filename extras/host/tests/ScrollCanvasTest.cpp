@@ -0,0 +1,51 @@
+// Frames copied from the scroll canvas match frames drawn directly, also after word wrap is switched
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string.h>
+
+static void notePage(MENU::structs::menuPageInfo *page_info)
+{
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size,
+                                            "Wrapped at spaces to the width\nShort line\n") + 1;
+}
+
+/// @brief Switch word wrap, draw the note page and draw it again scrolled by x, y
+static void draw(OledMenu &menu, MENU::structs::wrapCache *wrap, int x, int y)
+{
+    menu.setWordWrap(wrap);
+    menu.refreshDisplay();
+    menu.scroll(x, y);
+    menu.refreshDisplay();
+}
+
+int main()
+{
+    static char buffers[2][128];
+    static uint8_t canvas[4096];
+    static MENU::structs::wrapCache wraps[2];
+
+    SimulatedDisplay canvas_display;
+    StaticOledMenu<1> canvas_menu(canvas_display, 512, 500);
+    canvas_menu.init();
+    CHECK(canvas_menu.setScrollCanvas(canvas, sizeof(canvas)));
+    CHECK(canvas_menu.addMenuPage(MENU::structs::USER, false, notePage, buffers[0], sizeof(buffers[0])));
+
+    SimulatedDisplay direct_display;
+    StaticOledMenu<1> direct_menu(direct_display, 512, 500);
+    direct_menu.init();
+    CHECK(direct_menu.addMenuPage(MENU::structs::USER, false, notePage, buffers[1], sizeof(buffers[1])));
+
+    // Clipped, wrapped, clipped again, each scrolled so the canvas is used. The clipped lines fit the canvas as well,
+    // so every switch has to render it again
+    for (int step = 0; step < 3; step++)
+    {
+        bool wrapped = step == 1;
+        draw(canvas_menu, wrapped ? &wraps[0] : nullptr, 8, 0);
+        draw(direct_menu, wrapped ? &wraps[1] : nullptr, 8, 0);
+        CHECK(memcmp(canvas_display.getBufferPtr(), direct_display.getBufferPtr(), canvas_display.getFrameBufferSize()) == 0);
+    }
+    CHECK(canvas_menu.getCanvasRenders() == 3);
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Streamed pages read through a file backed reader: checkpoint halving, jumps past the end and a last line
+// without a trailing newline
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string>
+#include <vector>
+
+// Lines shown by the default font on the 128x64 SimulatedDisplay
+static const uint32_t visibleLines = 4;
+
+static std::vector<std::string> documentLines;
+static bool documentTrailingNewline;
+
+/// @brief Reader of a document in a file, like file.seek() and file.readBytes() on a flash filesystem
+static uint16_t readFile(uint32_t offset, char *dest, uint16_t length, void *context)
+{
+    FILE *file = static_cast<FILE *>(context);
+    if (fseek(file, offset, SEEK_SET) != 0)
+    {
+        return 0;
+    }
+    return fread(dest, 1, length, file);
+}
+
+/// @brief Write a document of lines of different lengths to a temporary file
+static FILE *makeDocument(uint32_t lines, bool trailing_newline)
+{
+    FILE *file = tmpfile();
+    CHECK(file != nullptr);
+    documentLines.clear();
+    documentTrailingNewline = trailing_newline;
+    for (uint32_t i = 0; i < lines; i++)
+    {
+        documentLines.push_back("L" + std::to_string(i) + std::string(i % 7, 'x'));
+        fputs(documentLines.back().c_str(), file);
+        if (trailing_newline || i + 1 < lines)
+        {
+            fputc('\n', file);
+        }
+    }
+    fflush(file);
+    return file;
+}
+
+/// @brief The window expected for a top line, the visible lines as they are in the file
+static std::string expectedWindow(uint32_t top)
+{
+    std::string window;
+    for (uint32_t i = top; i < documentLines.size() && i < top + visibleLines; i++)
+    {
+        window += documentLines[i];
+        if (documentTrailingNewline || i + 1 < documentLines.size())
+        {
+            window += '\n';
+        }
+    }
+    return window;
+}
+
+/// @brief Offset of a line in the document
+static uint32_t lineOffset(uint32_t line)
+{
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < line; i++)
+    {
+        offset += documentLines[i].size() + 1;
+    }
+    return offset;
+}
+
+static void checkDocument(uint32_t lines, bool trailing_newline)
+{
+    SimulatedDisplay display;
+    StaticOledMenu<1> menu(display, 512, 500);
+    menu.init();
+    FILE *file = makeDocument(lines, trailing_newline);
+    uint32_t checkpoints[8];
+    MENU::structs::streamDocument document(readFile, file, checkpoints, NELEMS(checkpoints), 4);
+    char window[96];
+    CHECK(menu.addStreamPage(true, &document, window, sizeof(window)));
+
+    menu.refreshDisplay();
+    CHECK(expectedWindow(document.top_line) == window);
+
+    for (int i = 0; i < 10; i++)
+    {
+        menu.postInput(MENU::structs::INPUT_EVENT::ITEM_DOWN);
+    }
+    menu.refreshDisplay();
+    CHECK(expectedWindow(document.top_line) == window);
+
+    // A jump past the end shows the last full window
+    document.top_line = lines + 1000;
+    menu.refreshDisplay();
+    CHECK(document.end_known);
+    CHECK(document.num_lines == lines);
+    CHECK(document.top_line == (lines > visibleLines ? lines - visibleLines : 0));
+    CHECK(expectedWindow(document.top_line) == window);
+
+    for (int i = 0; i < 3; i++)
+    {
+        menu.postInput(MENU::structs::INPUT_EVENT::ITEM_UP);
+    }
+    menu.refreshDisplay();
+    CHECK(expectedWindow(document.top_line) == window);
+
+    // An unchanged window is not read again
+    uint32_t bytes_read = document.bytes_read;
+    menu.refreshDisplay();
+    CHECK(document.bytes_read == bytes_read);
+
+    for (int i = 0; i < 200; i++)
+    {
+        document.top_line = rand() % (lines + 10);
+        menu.refreshDisplay();
+        CHECK(expectedWindow(document.top_line) == window);
+    }
+
+    // A jump reads at most one checkpoint interval of lines before the window
+    if (lines > 1000)
+    {
+        bytes_read = document.bytes_read;
+        document.top_line = lines / 2 + 1;
+        menu.refreshDisplay();
+        CHECK(expectedWindow(document.top_line) == window);
+        uint32_t checkpoint_line = document.top_line / document.checkpoint_interval * document.checkpoint_interval;
+        uint32_t scanned = lineOffset(document.top_line) - lineOffset(checkpoint_line);
+        CHECK(document.bytes_read - bytes_read <= scanned + 2 * sizeof(window));
+    }
+
+    CHECK(document.num_checkpoints <= NELEMS(checkpoints));
+    for (uint16_t i = 0; i < document.num_checkpoints; i++)
+    {
+        CHECK(checkpoints[i] == lineOffset(i * document.checkpoint_interval));
+    }
+    fclose(file);
+}
+
+int main()
+{
+    for (int trailing_newline = 0; trailing_newline < 2; trailing_newline++)
+    {
+        checkDocument(0, trailing_newline);
+        checkDocument(1, trailing_newline);
+        checkDocument(3, trailing_newline);
+        checkDocument(5000, trailing_newline);
+    }
+
+    // Eight checkpoints of 4 lines cover 32 lines, the 5000 line document needs the interval doubled 8 times
+    {
+        SimulatedDisplay display;
+        StaticOledMenu<1> menu(display, 512, 500);
+        menu.init();
+        FILE *file = makeDocument(5000, false);
+        uint32_t checkpoints[8];
+        MENU::structs::streamDocument document(readFile, file, checkpoints, NELEMS(checkpoints), 4);
+        char window[96];
+        CHECK(menu.addStreamPage(true, &document, window, sizeof(window)));
+        document.top_line = 6000;
+        menu.refreshDisplay();
+        CHECK(document.checkpoint_interval == 1024);
+        CHECK(document.num_checkpoints == 5);
+        CHECK(document.top_line == 5000 - visibleLines);
+        CHECK(expectedWindow(document.top_line) == window);
+        CHECK(std::string(window).back() != '\n');
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// A template page on the shared page buffer lays out its static text again after another page used the buffer,
+// and later frames only redraw the changed fields
+
+#include "HostTest.h"
+#include <U8G2OledMenu.h>
+#include <U8G2OledMenuSim.h>
+#include <string.h>
+
+static const char *layout = "{}\nUp {} s";
+static char deviceName[] = "sensor-01";
+static int32_t uptimeSeconds = 42;
+static char *sharedBuffer = nullptr;
+
+static void otherPage(MENU::structs::menuPageInfo *page_info)
+{
+    sharedBuffer = page_info->buffer;
+    page_info->needs_buffer_size =
+        snprintf(page_info->buffer, page_info->target_buffer_size, "Other page text\nline two\nline three\n") + 1;
+}
+
+/// @brief Check that the frame of menu is the frame a template page with a dedicated buffer draws
+static void checkFrame(SimulatedDisplay &display)
+{
+    SimulatedDisplay reference_display;
+    StaticOledMenu<1> reference(reference_display, 512, 500);
+    reference.init();
+    MENU::structs::templateField fields[] = {
+        {MENU::structs::STRING, deviceName, 10},
+        {MENU::structs::INT, &uptimeSeconds, 6},
+    };
+    static char page_buffer[64];
+    CHECK(reference.addTemplatePage(false, layout, fields, NELEMS(fields), page_buffer, sizeof(page_buffer)));
+    reference.refreshDisplay();
+    CHECK(memcmp(display.getBufferPtr(), reference_display.getBufferPtr(), display.getFrameBufferSize()) == 0);
+}
+
+int main()
+{
+    SimulatedDisplay display;
+    StaticOledMenu<2> menu(display, 512, 500);
+    menu.init();
+    MENU::structs::templateField fields[] = {
+        {MENU::structs::STRING, deviceName, 10},
+        {MENU::structs::INT, &uptimeSeconds, 6},
+    };
+    CHECK(menu.addTemplatePage(false, layout, fields, NELEMS(fields), nullptr, 0));
+    CHECK(menu.addMenuPage(MENU::structs::USER, false, otherPage, nullptr, 0));
+
+    menu.refreshDisplay();
+    checkFrame(display);
+
+    // The other page writes its text over the expanded layout
+    menu.postInput(MENU::structs::INPUT_EVENT::NEXT_PAGE);
+    menu.refreshDisplay();
+    CHECK(sharedBuffer != nullptr);
+    CHECK(strncmp(sharedBuffer, "Other page", 10) == 0);
+
+    menu.postInput(MENU::structs::INPUT_EVENT::PREVIOUS_PAGE);
+    menu.refreshDisplay();
+    CHECK(strcmp(sharedBuffer, "sensor-01 \nUp     42 s") == 0);
+    checkFrame(display);
+
+    // An unchanged page draws nothing, a changed field only redraws its line
+    uint32_t draw_calls = menu.getDrawCalls();
+    uint32_t frames_skipped = menu.getFramesSkipped();
+    menu.refreshDisplay();
+    CHECK(menu.getDrawCalls() == draw_calls);
+    CHECK(menu.getFramesSkipped() == frames_skipped + 1);
+
+    // A partial redraw keeps the last frame, a pixel set on the last row outside the text stays set
+    uint8_t *last_column = display.getBufferPtr() + display.getFrameBufferSize() - 1;
+    *last_column |= 0x80;
+    uptimeSeconds = 1234;
+    menu.refreshDisplay();
+    CHECK(strcmp(sharedBuffer, "sensor-01 \nUp   1234 s") == 0);
+    CHECK(menu.getDrawCalls() > draw_calls);
+    CHECK((*last_column & 0x80) != 0);
+    *last_column &= ~0x80;
+    checkFrame(display);
+
+    // A full frame clears it
+    *last_column |= 0x80;
+    menu.invalidateDisplay();
+    menu.refreshDisplay();
+    CHECK((*last_column & 0x80) == 0);
+    checkFrame(display);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Round trip of the mirror stream: run mirror_producer, rebuild its frames with mirror_decode.py and compare them
+with the frames the producer drew.
+
+    python3 mirror_roundtrip.py <mirror_producer> <mirror_decode.py>
+
+Frames that did not change the display are not mirrored, so the rebuilt frames must be the drawn frames in order
+with repeats left out, ending with the last frame drawn.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def read_frames(directory, prefix):
+    return [open(os.path.join(directory, name), "rb").read()
+            for name in sorted(os.listdir(directory)) if name.startswith(prefix)]
+
+
+def main():
+    producer, decoder = sys.argv[1:3]
+    with tempfile.TemporaryDirectory() as work:
+        references = os.path.join(work, "refs")
+        frames = os.path.join(work, "frames")
+        os.makedirs(references)
+        stream = subprocess.run([producer, references], check=True, stdout=subprocess.PIPE).stdout
+        decoded = subprocess.run([sys.executable, decoder, "-", frames], input=stream, check=True,
+                                 stderr=subprocess.PIPE)
+        print(decoded.stderr.decode().strip())
+
+        expected = read_frames(references, "ref_")
+        distinct = [frame for i, frame in enumerate(expected) if i == 0 or frame != expected[i - 1]]
+        rebuilt = read_frames(frames, "frame_")
+        if rebuilt != distinct:
+            print("rebuilt %d frames, expected %d distinct frames" % (len(rebuilt), len(distinct)))
+            for i, (got, want) in enumerate(zip(rebuilt, distinct)):
+                if got != want:
+                    print("first difference in frame %d" % (i + 1))
+                    break
+            return 1
+        if b" 1 rejected" not in decoded.stderr:
+            print("expected the stray sync in the sketch output to be rejected")
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Rebuild the frames written by OledMenu::setMirror() and save them as PBM images.
+
+The input is a file, "-" for stdin, "tcp:HOST:PORT" for a socket or a serial device such as
+/dev/ttyUSB0 (needs pyserial). Bytes outside of mirror frames, like Serial.print() output of the
+sketch, are skipped. Delta frames are only applied after a full frame was received. The host build in
+extras/host has a producer to try it without a board, its round trip is the mirror_roundtrip test.
+
+    build/mirror_producer refs/ | python3 extras/mirror_decode.py - frames/
+    python3 mirror_decode.py /dev/ttyUSB0 frames/ --baud 115200 --latest
+"""
+
+import argparse
+import os
+import socket
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+END = 0xFF
+
+
+def fnv1a(data, value=2166136261):
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def unpack_bits(data, pos, length):
+    """Decode length PackBits encoded bytes starting at pos, return them and the position after them."""
+    out = bytearray()
+    while len(out) < length:
+        header = data[pos]
+        pos += 1
+        if header < 128:
+            out += data[pos:pos + header + 1]
+            pos += header + 1
+        elif header > 128:
+            out += bytes([data[pos]]) * (257 - header)
+            pos += 1
+    if len(out) != length:
+        raise ValueError("run overflows its tiles")
+    return bytes(out), pos
+
+
+def parse_frame(data, pos):
+    """Parse the frame whose sync starts at pos.
+
+    Returns (frame, next position), (None, None) if more bytes are needed, or raises ValueError.
+    """
+    try:
+        body = pos + 2
+        kind, sequence, cols, rows, layout = struct.unpack_from("<cHBBB", data, body)
+        if kind not in (b"K", b"D") or layout > 1:
+            raise ValueError("bad header")
+        cursor = body + 6
+        runs = []
+        while data[cursor] != END:
+            tx, ty, count = data[cursor], data[cursor + 1], data[cursor + 2]
+            if ty >= rows or tx + count > cols or count == 0:
+                raise ValueError("run outside of the display")
+            tiles, cursor = unpack_bits(data, cursor + 3, count * 8)
+            runs.append((tx, ty, tiles))
+        cursor += 1
+        (checksum,) = struct.unpack_from("<I", data, cursor)
+    except (IndexError, struct.error):
+        return None, None
+    if fnv1a(data[body:cursor]) != checksum:
+        raise ValueError("checksum mismatch")
+    frame = {"key": kind == b"K", "sequence": sequence, "cols": cols, "rows": rows, "layout": layout, "runs": runs}
+    return frame, cursor + 4
+
+
+class Mirror:
+    def __init__(self):
+        self.buffer = None
+        self.cols = self.rows = self.layout = 0
+        self.sequence = None
+
+    def apply(self, frame):
+        """Apply a frame, return False if it cannot be applied to the current image."""
+        if frame["key"]:
+            self.cols, self.rows, self.layout = frame["cols"], frame["rows"], frame["layout"]
+            self.buffer = bytearray(self.cols * self.rows * 8)
+        elif self.buffer is None or (frame["cols"], frame["rows"]) != (self.cols, self.rows):
+            return False
+        elif self.sequence is not None and frame["sequence"] != (self.sequence + 1) & 0xFFFF:
+            # A delta frame was lost, wait for the next full frame
+            self.buffer = None
+            return False
+        for tx, ty, tiles in frame["runs"]:
+            offset = (ty * self.cols + tx) * 8
+            self.buffer[offset:offset + len(tiles)] = tiles
+        self.sequence = frame["sequence"]
+        return True
+
+    def pixel(self, x, y):
+        if self.layout == 0:
+            # Vertical tiles: one byte is 8 pixels of a column, least significant bit on top
+            return self.buffer[(y // 8) * self.cols * 8 + x] >> (y % 8) & 1
+        # Horizontal rows: one byte is 8 pixels of a row, most significant bit on the left
+        return self.buffer[y * self.cols + x // 8] >> (7 - x % 8) & 1
+
+    def to_pbm(self):
+        width, height = self.cols * 8, self.rows * 8
+        rows = bytearray()
+        for y in range(height):
+            for x0 in range(0, width, 8):
+                byte = 0
+                for bit in range(8):
+                    byte |= self.pixel(x0 + bit, y) << (7 - bit)
+                rows.append(byte)
+        return b"P4\n%d %d\n" % (width, height) + bytes(rows)
+
+
+def open_input(name, baud):
+    if name == "-":
+        return lambda: sys.stdin.buffer.read1(4096)
+    if name.startswith("tcp:"):
+        _, host, port = name.split(":")
+        connection = socket.create_connection((host, int(port)))
+        return lambda: connection.recv(4096)
+    if name.startswith("/dev/"):
+        import serial
+        port = serial.Serial(name, baud, timeout=1)
+        return lambda: port.read(port.in_waiting or 1)
+    stream = open(name, "rb")
+    return lambda: stream.read(4096)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help='file, "-" for stdin, tcp:HOST:PORT or a serial device')
+    parser.add_argument("output", help="directory for the PBM frames")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of a serial device")
+    parser.add_argument("--latest", action="store_true", help="only keep latest.pbm instead of one file per frame")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    read = open_input(args.input, args.baud)
+    mirror = Mirror()
+    data = bytearray()
+    frames = payload = rejected = 0
+    serial_device = args.input.startswith("/dev/")
+
+    while True:
+        chunk = read()
+        if not chunk and not serial_device:
+            break
+        data += chunk
+        while True:
+            pos = data.find(SYNC)
+            if pos < 0:
+                del data[:max(0, len(data) - 1)]
+                break
+            try:
+                frame, end = parse_frame(data, pos)
+            except ValueError:
+                # Not a frame or a corrupted one, look for the next sync
+                rejected += 1
+                del data[:pos + 1]
+                continue
+            if frame is None:
+                del data[:pos]
+                break
+            payload += end - pos
+            del data[:end]
+            if not mirror.apply(frame):
+                continue
+            frames += 1
+            name = "latest.pbm" if args.latest else "frame_%05d.pbm" % frames
+            with open(os.path.join(args.output, name), "wb") as image:
+                image.write(mirror.to_pbm())
+
+    print("%d frames, %d mirror bytes, %d rejected" % (frames, payload, rejected), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,31 +1,109 @@
 #include "U8G2OledMenu.h"
 
+// Time a render stage, compiled out unless OLED_MENU_ENABLE_STATS is defined
+#if defined(OLED_MENU_ENABLE_STATS)
+#define OLED_MENU_STAGE_BEGIN(name) unsigned long name##_start = micros()
+#define OLED_MENU_STAGE_END(name, stage) recordStageTime(stage, micros() - name##_start)
+#else
+#define OLED_MENU_STAGE_BEGIN(name)
+#define OLED_MENU_STAGE_END(name, stage)
+#endif
+
+// Record a trace event, compiled out unless OLED_MENU_ENABLE_TRACE is defined
+#if defined(OLED_MENU_ENABLE_TRACE)
+#define OLED_MENU_TRACE_BEGIN(name) unsigned long name##_trace = micros()
+#define OLED_MENU_TRACE_END(name, event, arg) recordTrace(event, name##_trace, micros() - name##_trace, arg, false)
+#define OLED_MENU_TRACE_INSTANT(event, arg) recordTrace(event, micros(), 0, arg, true)
+#else
+#define OLED_MENU_TRACE_BEGIN(name)
+#define OLED_MENU_TRACE_END(name, event, arg)
+#define OLED_MENU_TRACE_INSTANT(event, arg)
+#endif
+
 /// @brief Constructor for OledMenu
 /// @param display Reference to the U8G2 display object
 /// @param buffer_size Size of the display buffer
 /// @param text_blink_delay Delay for text blinking
 OledMenu::OledMenu(U8G2 &display, uint16_t buffer_size, uint32_t text_blink_delay)
-    : display_hal(display), display_buffer_size(buffer_size), mmptr(new MemoryManager(buffer_size)),
-      display_buffer(*mmptr), error_buffer_(reinterpret_cast<char *>(display_buffer.allocate(display_buffer.size() / 2))),
-      error_buffer_size(display_buffer.size() / 2), num_pages(0), page_buffer_(nullptr),
-      page_buffer_size(0), num_error(0), error_message_display_override(false), current_page_displayed(0),
-      page_entered(false), line_blinking(false), display_connected(false), page_info(nullptr),
+    : OledMenu(display, buffer_size, text_blink_delay,
+               new MENU::structs::menuPageInfo[OLED_MENU_DEFAULT_MAX_PAGES], OLED_MENU_DEFAULT_MAX_PAGES,
+               new MENU::structs::errorPageInfo[OLED_MENU_DEFAULT_MAX_ERROR_PAGES], OLED_MENU_DEFAULT_MAX_ERROR_PAGES)
+{
+    owns_page_tables = true;
+}
+
+/// @brief Constructor for OledMenu using caller provided page tables
+/// @param display Reference to the U8G2 display object
+/// @param buffer_size Size of the display buffer
+/// @param text_blink_delay Delay for text blinking
+/// @param page_table Storage for the menu pages
+/// @param page_table_size Number of entries in page_table
+/// @param error_page_table Storage for the error pages
+/// @param error_page_table_size Number of entries in error_page_table
+/// @param display_buffer_memory Storage for the display buffer of buffer_size bytes, nullptr to allocate it
+OledMenu::OledMenu(U8G2 &display, uint16_t buffer_size, uint32_t text_blink_delay,
+                   MENU::structs::menuPageInfo *page_table, uint8_t page_table_size,
+                   MENU::structs::errorPageInfo *error_page_table, uint8_t error_page_table_size,
+                   uint8_t *display_buffer_memory)
+    : display_hal(display), pages(page_table), error_pages(error_page_table), max_pages(page_table_size),
+      max_error_pages(error_page_table_size), num_error_pages(0), owns_page_tables(false),
+      owns_display_buffer(display_buffer_memory == nullptr),
+      display_buffer(display_buffer_memory != nullptr ? display_buffer_memory : new uint8_t[buffer_size]),
+      display_buffer_size(buffer_size), error_buffer_(reinterpret_cast<char *>(display_buffer)),
+      error_buffer_size(buffer_size / 4), page_buffer_(reinterpret_cast<char *>(display_buffer) + buffer_size / 4),
+      page_buffer_size(buffer_size / 4), num_pages(0), num_error(0), error_message_display_override(false), current_page_displayed(0),
+      page_entered(false), line_blinking(false), display_connected(false), dirty_tile_tracking(false),
+      tile_shadow_stale_rows(0), tile_shadow_buffer(nullptr), tile_shadow_size(0), tiles_sent(0), tiles_skipped(0),
+      mirror_out(nullptr), mirror_shadow(nullptr), mirror_shadow_size(0), mirror_sequence(0), mirror_keyframe_interval(0),
+      mirror_frames_since_key(0), mirror_keyframe_due(false), mirror_checksum(0), mirror_bytes(0),
+      async_flush(false), flush_pending_rows(0), flush_next_row(0), flush_rows_per_service(1), flush_budget_us(0), frames_coalesced(0),
+      scroll_canvas(nullptr), scroll_canvas_size(0), canvas_tile_cols(0), canvas_tile_rows(0), canvas_source(nullptr),
+      canvas_hash(0), canvas_font_index(0), canvas_valid(false), canvas_renders(0),
+      line_cache_memory(nullptr), line_cache_size(0), line_cache_entries(nullptr), line_cache_data(nullptr), line_cache_slots(0),
+      line_cache_bands(0), line_cache_font(nullptr), line_cache_clock(0), line_cache_hits(0), line_cache_misses(0),
+      last_frame_hash(0), text_hash(0), last_state_hash(0), last_rendered_page(nullptr), frame_hash_valid(false), frames_drawn(0), frames_skipped(0), draw_calls(0),
+      error_head(0), error_sequence(0), errors_dropped(0), formatted_error_id(0), formatted_error_count(0),
+      input_head(0), input_tail(0), inputs_dropped(0),
+      idle_policy(false), idle_dim_ms(0), idle_sleep_ms(0), dim_contrast(0), awake_contrast(OLED_MENU_CONTRAST_UNCHANGED), contrast_lowered(false), power_state(MENU::structs::AWAKE),
+      idle_activity(false), last_activity(0), power_error_sequence(0), page_info(nullptr),
       text(nullptr), buffer(nullptr), bufferSize(0), blinkState(false), blinkEnabled(false),
-      highlightEnabled(false), lastBlinkTime(0), minLines(1), maxLines(10), dispLines(4), maxWidth(display_hal.getDisplayWidth()), maxHeight(display_hal.getDisplayHeight()),
+      highlightEnabled(false), lastBlinkTime(0), minLines(1), maxLines(10), dispLines(4),
       u8g2_font_lookup_table{
           u8g2_font_3x3basic_tr, u8g2_font_u8glib_4_tr, u8g2_font_tiny5_tr, u8g2_font_5x7_tr,
           u8g2_font_6x10_tr, u8g2_font_t0_11_tr, u8g2_font_6x13_tr, u8g2_font_7x14_tr,
           u8g2_font_t0_17_tr, u8g2_font_helvR12_tr, u8g2_font_10x20_tf, u8g2_font_profont22_tr,
           u8g2_font_courB18_tr, u8g2_font_crox5t_tr, u8g2_font_crox5h_tr, u8g2_font_ncenR18_tr,
           u8g2_font_courR24_tr, u8g2_font_fur20_tr, u8g2_font_osr21_tr, u8g2_font_logisoso22_tr,
-          u8g2_font_timR24_tr}
+          u8g2_font_timR24_tr},
+      font_metrics_valid(false), line_font_index(0), wrap_cache(nullptr), maxWidth(display_hal.getDisplayWidth()),
+      maxHeight(display_hal.getDisplayHeight())
 {
+    (void)text_blink_delay; // The cursor blinks every blinkInterval
+    memset(display_buffer, '\0', display_buffer_size);
+#if defined(OLED_MENU_ENABLE_STATS)
+    resetRenderStats();
+#endif
+#if defined(OLED_MENU_ENABLE_TRACE)
+    clearTrace();
+#endif
+    text_arena.init(display_buffer + error_buffer_size + page_buffer_size, display_buffer_size - error_buffer_size - page_buffer_size);
+    selectLineFont();
 }
 
 /// @brief Destructor for OledMenu
 OledMenu::~OledMenu()
 {
-    delete mmptr;
+    if (owns_page_tables)
+    {
+        delete[] pages;
+        delete[] error_pages;
+    }
+    delete[] tile_shadow_buffer;
+    delete[] mirror_shadow;
+    if (owns_display_buffer)
+    {
+        delete[] display_buffer;
+    }
 }
 
 /// @brief Initialize connected display
@@ -34,9 +112,12 @@ void OledMenu::init()
     if (display_hal.begin())
     {
         display_connected = true;
+        frame_hash_valid = false;
         display_hal.setFont(u8g2_font_helvB08_tf);
         display_hal.setFontRefHeightExtendedText();
         display_hal.enableUTF8Print();
+        font_metrics_valid = false;
+        buildFontMetrics();
     }
     else
     {
@@ -48,555 +129,3633 @@ void OledMenu::init()
 /// @param showCursor Whether to show the cursor.
 void OledMenu::displayText(bool showCursor)
 {
-    if (buffer == nullptr)
+    // Nothing to do if the frame is identical to the one on the display
+    OLED_MENU_TRACE_BEGIN(display);
+    OLED_MENU_STAGE_BEGIN(layout);
+    uint32_t hash = frameFingerprint(showCursor);
+    if (frame_hash_valid && hash == last_frame_hash)
+    {
+        frames_skipped++;
+        OLED_MENU_STAGE_END(layout, MENU::structs::RENDER_STAGE::LAYOUT);
+        OLED_MENU_TRACE_END(display, MENU::structs::TRACE_DISPLAY_TEXT, 0);
+        return;
+    }
+    last_frame_hash = hash;
+    frame_hash_valid = true;
+    frames_drawn++;
+
+    if (buffer != nullptr && (line_index.source != buffer || line_index.hash != text_hash ||
+                              line_index.wrap_font != (wrap_cache != nullptr ? getLineFont() : nullptr)))
+    {
+        buildLineIndex(buffer, bufferSize, text_hash);
+    }
+    OLED_MENU_STAGE_END(layout, MENU::structs::RENDER_STAGE::LAYOUT);
+
+    OLED_MENU_STAGE_BEGIN(draw);
+    if (isPageBufferMode())
+    {
+        // Draw the frame strip by strip, U8G2 sends each strip from nextPage()
+        display_hal.firstPage();
+        do
+        {
+            int strip_top = display_hal.getBufferCurrTileRow() * 8;
+            drawText(showCursor, strip_top, strip_top + display_hal.getBufferTileHeight() * 8);
+        } while (display_hal.nextPage());
+        OLED_MENU_STAGE_END(draw, MENU::structs::RENDER_STAGE::DRAW);
+        OLED_MENU_TRACE_END(display, MENU::structs::TRACE_DISPLAY_TEXT, 1);
+        return;
+    }
+
+    if (!showCursor && prepareScrollCanvas())
+    {
+        blitScrollCanvas();
+    }
+    else
     {
         display_hal.clearBuffer();
-        display_hal.sendBuffer();
+        drawText(showCursor, 0, maxHeight);
+    }
+    OLED_MENU_STAGE_END(draw, MENU::structs::RENDER_STAGE::DRAW);
+    flushDisplay();
+    OLED_MENU_TRACE_END(display, MENU::structs::TRACE_DISPLAY_TEXT, 1);
+}
+
+/// @brief Draw the indexed lines that intersect a horizontal band of the display
+/// @param showCursor Whether to show the cursor.
+/// @param top Y position of the top of the band
+/// @param bottom Y position below the bottom of the band
+void OledMenu::drawText(bool showCursor, int top, int bottom)
+{
+    if (buffer == nullptr)
+    {
         return;
     }
 
-    display_hal.clearBuffer();
     setFontSizeForLineLimits();
     display_hal.setFontMode(1); // Enable transparent mode for highlighting
 
-    int lineSpacing = display_hal.getMaxCharHeight();
-    int maxLines = display_hal.getDisplayHeight() / lineSpacing;
-    char *line;
-    char *savePtr;
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    int lineSpacing = metrics.line_spacing;
 
-    line = strtok_r(buffer, "\n", &savePtr);
+    // Jump straight to the first line whose descent reaches into the band
+    int below_top = top + metrics.descent - page_info->anchorY;
+    uint16_t line = below_top < 0 ? 0 : below_top / lineSpacing + 1;
+    int currentY = page_info->anchorY + line * lineSpacing;
 
-    int currentY = page_info->anchorY;
-    int lineCount = 0;
-    while (line != NULL && lineCount < maxLines)
+    while (line < line_index.num_lines && currentY - lineSpacing < bottom)
     {
         if (highlightEnabled)
         {
             display_hal.drawBox(page_info->anchorX, currentY - lineSpacing, maxWidth, lineSpacing);
+            draw_calls++;
         }
-        display_hal.drawStr(page_info->anchorX, currentY, line);
+        drawIndexedLine(line, page_info->anchorX, currentY);
         if (showCursor)
         {
             display_hal.drawVLine(page_info->cursorX, currentY - lineSpacing, lineSpacing);
+            draw_calls++;
         }
         currentY += lineSpacing;
-        line = strtok_r(NULL, "\n", &savePtr);
-        lineCount++;
-    }
-
-    // Fill remaining lines with empty space if less than maxLines
-    while (lineCount < maxLines)
-    {
-        currentY += lineSpacing;
-        lineCount++;
+        line++;
     }
-
-    display_hal.sendBuffer();
 }
 
-/// @brief Add a page to the menu
-/// @param type Type of the page
-/// @param interactive Whether the page is interactive
-/// @param callback Callback function for the page
-/// @param page_buffer Buffer for the page content
-/// @param target_buffer_size Size of the page buffer
-/// @return True if the page was added successfully, false otherwise
-bool OledMenu::addMenuPage(MENU::structs::PAGE_TYPE type, bool interactive, MENU::structs::menu_callback callback, char *page_buffer, uint16_t target_buffer_size)
+/// @brief Check if the display uses a page buffer (_1/_2) constructor
+/// @return True if the frame buffer holds only a strip of the display, false otherwise
+bool OledMenu::isPageBufferMode()
 {
-    if (page_buffer == nullptr || target_buffer_size == 0)
-    {
-        page_buffer = page_buffer_;
-        target_buffer_size = page_buffer_size;
-    }
-
-    MENU::structs::menuPageInfo page_info(type, interactive, callback, page_buffer, target_buffer_size);
-    page_info.callback(&page_info); // Call the callback function to populate the page buffer
-
-    // Check if the buffer size is sufficient
-    if (page_info.needs_buffer_size > target_buffer_size)
-    {
-        clearDisplayBuffer();
-        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
-        displayText(false);
-        return false;
-    }
-
-    pages.insertAtEnd(type, interactive, callback, page_buffer, target_buffer_size);
-    MENU::structs::menuPageInfo *page = pages.getLastAccessedNodeStoragePtr();
-    if (page)
-    {
-        page->max_chars_on_line = calculateMaxCharsOnLine(page_buffer, target_buffer_size); // Set max_chars_on_line
-        num_pages++;
-        return true;
-    }
-    return false;
+    return display_hal.getBufferTileHeight() * 8 < display_hal.getDisplayHeight();
 }
 
-/// @brief Add an error page to the menu
-/// @param callback Callback function for the error page
-/// @return True if the error page was added successfully, false otherwise
-bool OledMenu::addErrorPage(MENU::structs::menu_callback callback)
+/// @brief Index the line starts and lengths of a text buffer, without modifying it
+/// @param text Text to index
+/// @param size Size of the text buffer
+/// @param hash Hash of the text, used to detect when the index is stale
+void OledMenu::buildLineIndex(const char *text, uint16_t size, uint32_t hash)
 {
-    MENU::structs::errorPageInfo page_info(MENU::structs::PAGE_TYPE::ERROR, false, callback, error_buffer_, error_buffer_size);
-    page_info.callback(&page_info); // Call the callback function to populate the page buffer
-
-    // Check if the buffer size is sufficient
-    if (page_info.needs_buffer_size > error_buffer_size)
+    line_index.source = text;
+    line_index.hash = hash;
+    line_index.num_lines = 0;
+    line_index.max_chars_on_line = 0;
+    line_index.max_line_width = 0;
+    line_index.wrap_font = nullptr;
+    line_index.lines_dropped = 0;
+    line_index.lines_cut = 0;
+    if (wrap_cache != nullptr)
     {
-        clearDisplayBuffer();
-        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
-        displayText(false);
-        return false;
+        prepareWrapCache();
+        line_index.wrap_font = wrap_cache->font;
     }
 
-    pages.insertAtEnd(MENU::structs::PAGE_TYPE::ERROR, false, callback, error_buffer_, error_buffer_size);
-    MENU::structs::errorPageInfo *page = error_pages.getLastAccessedNodeStoragePtr();
-    if (page)
+    uint16_t line_start = 0;
+    uint16_t text_line = 0;
+    uint16_t wrapped_lines = 0;
+    for (uint16_t i = 0; i <= size; i++)
     {
-        page->max_chars_on_line = calculateMaxCharsOnLine(error_buffer_, error_buffer_size); // Set max_chars_on_line
-        num_error++;
-        return true;
-    }
-    return false;
-}
+        bool end_of_text = (i == size || text[i] == '\0');
+        if (!end_of_text && text[i] != '\n')
+        {
+            continue;
+        }
 
-uint8_t OledMenu::calculateMaxCharsOnLine(char *buffer, uint16_t buffer_size)
-{
-    uint8_t max_chars = 0;
-    uint8_t current_chars = 0;
-    for (uint16_t i = 0; i < buffer_size; i++)
-    {
-        if (buffer[i] == '\n' || buffer[i] == '\0')
+        uint16_t chars = i - line_start;
+        // A trailing newline does not start another line
+        if (chars == 0 && end_of_text)
+        {
+            break;
+        }
+        if (line_index.num_lines >= OLED_MENU_MAX_LINES)
+        {
+            // Keep counting, so the caller can tell the text was not shown in full
+            line_index.lines_dropped++;
+        }
+        else if (wrap_cache != nullptr)
         {
-            if (current_chars > max_chars)
+            if (chars > 255)
             {
-                max_chars = current_chars;
+                line_index.lines_cut++;
             }
-            current_chars = 0;
-            if (buffer[i] == '\0')
+            if (indexWrappedLine(text, line_start, chars, text_line))
             {
-                break;
+                if (wrapped_lines == text_line)
+                {
+                    wrapped_lines++;
+                }
+            }
+            else
+            {
+                line_index.lines_dropped++;
             }
+            text_line++;
         }
         else
         {
-            current_chars++;
+            if (chars > OLED_MENU_MAX_LINE_CHARS)
+            {
+                line_index.lines_cut++;
+            }
+            line_index.start[line_index.num_lines] = line_start;
+            line_index.length[line_index.num_lines] = chars > 255 ? 255 : chars;
+            line_index.num_lines++;
+            if (chars > line_index.max_chars_on_line)
+            {
+                line_index.max_chars_on_line = chars;
+            }
+        }
+        if (end_of_text)
+        {
+            break;
         }
+        line_start = i + 1;
     }
-    return max_chars;
-}
 
-/// @brief Refresh the display
-void OledMenu::refreshDisplay()
-{
-    if (display_connected)
+    if (wrap_cache != nullptr)
     {
-        if (error_message_display_override)
+        // Keep the rows relative to the start of their text line, so the next layout can reuse them
+        for (uint16_t line = 0; line < wrapped_lines; line++)
         {
-            renderErrorPageText();
+            uint8_t first = wrap_cache->first_row[line];
+            for (uint8_t row = first; row < first + wrap_cache->num_rows[line]; row++)
+            {
+                wrap_cache->row_start[row] = line_index.start[row] - line_index.start[first];
+                wrap_cache->row_length[row] = line_index.length[row];
+            }
         }
-        else
+        wrap_cache->num_lines = wrapped_lines;
+    }
+
+    if (page_info != nullptr && page_info->buffer == text)
+    {
+        page_info->num_lines = line_index.num_lines;
+        page_info->max_chars_on_line = line_index.max_chars_on_line;
+        if (page_info->page_line < line_index.num_lines)
         {
-            renderMenuPageText();
+            page_info->chars_on_line = line_index.length[page_info->page_line];
         }
-        manageCursorBlink();
     }
 }
 
-/// @brief Move to the next page
-void OledMenu::moveToNextPage()
+/// @brief Add the wrapped rows of a text line to the line index, reusing the last layout if the line is unchanged
+/// @param text Indexed text
+/// @param start Offset of the first character of the line
+/// @param chars Number of characters of the line
+/// @param text_line Index of the line in the text
+/// @return True if all rows of the line fit in the line index, false otherwise
+bool OledMenu::indexWrappedLine(const char *text, uint16_t start, uint16_t chars, uint16_t text_line)
 {
-    if (current_page_displayed < num_pages)
+    MENU::structs::wrapCache &cache = *wrap_cache;
+    if (chars > 255)
+    {
+        chars = 255;
+    }
+    uint32_t hash = hashBytes(2166136261UL, text + start, chars);
+    uint16_t first_row = line_index.num_lines;
+    uint16_t widest = 0;
+    bool complete = true;
+
+    if (text_line < cache.num_lines && cache.line_hash[text_line] == hash)
     {
-        current_page_displayed++;
+        // Unchanged line, its rows only move with the lines before it
+        for (uint8_t r = 0; r < cache.num_rows[text_line]; r++)
+        {
+            if (line_index.num_lines >= OLED_MENU_MAX_LINES)
+            {
+                complete = false;
+                break;
+            }
+            uint8_t row = cache.first_row[text_line] + r;
+            line_index.start[line_index.num_lines] = start + cache.row_start[row];
+            line_index.length[line_index.num_lines] = cache.row_length[row];
+            line_index.num_lines++;
+        }
+        widest = cache.line_width[text_line];
     }
-    if (current_page_displayed == num_pages)
+    else
     {
-        current_page_displayed = 0;
+        // Greedy wrap: a row ends at the last space that fits, or inside a word longer than the row
+        uint16_t pos = 0;
+        do
+        {
+            if (line_index.num_lines >= OLED_MENU_MAX_LINES)
+            {
+                complete = false;
+                break;
+            }
+            uint16_t width = 0;
+            uint16_t i = pos;
+            int16_t last_space = -1;
+            uint16_t width_at_space = 0;
+            while (i < chars)
+            {
+                uint8_t advance = glyphAdvance(text[start + i]);
+                if (width + advance > cache.width && i > pos)
+                {
+                    break;
+                }
+                if (text[start + i] == ' ')
+                {
+                    last_space = i;
+                    width_at_space = width;
+                }
+                width += advance;
+                i++;
+            }
+
+            uint16_t end = i;
+            uint16_t next = i;
+            if (i < chars && text[start + i] == ' ')
+            {
+                next = i + 1;
+            }
+            else if (i < chars && last_space > static_cast<int16_t>(pos))
+            {
+                end = last_space;
+                next = last_space + 1;
+                width = width_at_space;
+            }
+            line_index.start[line_index.num_lines] = start + pos;
+            line_index.length[line_index.num_lines] = end - pos;
+            line_index.num_lines++;
+            if (width > widest)
+            {
+                widest = width;
+            }
+            pos = next;
+        } while (pos < chars);
     }
-}
 
-/// @brief Move to the previous page
-void OledMenu::moveToPreviousPage()
-{
-    if (current_page_displayed > 0)
+    for (uint16_t row = first_row; row < line_index.num_lines; row++)
     {
-        current_page_displayed--;
-        return;
+        if (line_index.length[row] > line_index.max_chars_on_line)
+        {
+            line_index.max_chars_on_line = line_index.length[row];
+        }
     }
-    if (current_page_displayed == 0)
+    if (widest > line_index.max_line_width)
     {
-        current_page_displayed = num_pages - 1;
+        line_index.max_line_width = widest;
     }
+
+    cache.line_hash[text_line] = hash;
+    cache.first_row[text_line] = first_row;
+    cache.num_rows[text_line] = line_index.num_lines - first_row;
+    cache.line_width[text_line] = widest;
+    return complete;
 }
 
-/// @brief Move up an item in the menu
-void OledMenu::moveUpMenuItem()
+/// @brief Measure the glyph advances of the line font for word wrap, if they are not measured yet
+void OledMenu::prepareWrapCache()
 {
-    page_info = getMenuPageInfo(current_page_displayed);
-
-    if (page_info->page_line > 0)
+    const uint8_t *font = getLineFont();
+    if (wrap_cache->font == font && wrap_cache->width == maxWidth)
     {
-        page_info->page_line--;
         return;
     }
-    if (page_info->page_line == 0)
+
+    // One table per font, so measuring a line is a lookup per character instead of a font decode
+    setFontSizeForLineLimits();
+    for (uint8_t c = 0; c < sizeof(wrap_cache->advance); c++)
     {
-        page_info->page_line = page_info->num_lines - 1;
+        int8_t advance = u8g2_GetGlyphWidth(display_hal.getU8g2(), ' ' + c);
+        wrap_cache->advance[c] = advance > 0 ? advance : 0;
     }
+    wrap_cache->font = font;
+    wrap_cache->width = maxWidth;
+    wrap_cache->num_lines = 0; // Line breaks of another font or width do not apply
 }
 
-/// @brief Move down an item in the menu
-void OledMenu::moveDownMenuItem()
+/// @brief Get the advance of a glyph of the line font
+/// @param c Character
+/// @return Advance in pixels
+uint8_t OledMenu::glyphAdvance(uint8_t c)
 {
-    page_info = getMenuPageInfo(current_page_displayed);
-    if (page_info->page_line < page_info->num_lines)
-    {
-        page_info->page_line++;
-    }
-    if (page_info->page_line == page_info->num_lines)
+    if (c >= ' ' && c - ' ' < static_cast<int>(sizeof(wrap_cache->advance)))
     {
-        page_info->page_line = 0;
+        return wrap_cache->advance[c - ' '];
     }
+    int8_t advance = u8g2_GetGlyphWidth(display_hal.getU8g2(), c);
+    return advance > 0 ? advance : 0;
 }
 
-/// @brief Clear the display buffer
-void OledMenu::clearDisplayBuffer()
+/// @brief Use an off-screen canvas for scrolling pages.
+/// @param canvas Memory for the canvas, nullptr to disable it.
+/// @param size Size of the canvas memory.
+/// @return True if the scroll canvas is active, false otherwise.
+bool OledMenu::setScrollCanvas(uint8_t *canvas, uint16_t size)
 {
-    memset(&display_buffer, '\0', display_buffer_size);
+    canvas_valid = false;
+    frame_hash_valid = false;
+
+    // The canvas is copied byte by byte into a full frame buffer with vertical tiles
+    if (canvas == nullptr || size == 0 || isPageBufferMode() ||
+        display_hal.getU8g2()->ll_hvline != u8g2_ll_hvline_vertical_top_lsb)
+    {
+        scroll_canvas = nullptr;
+        scroll_canvas_size = 0;
+        return false;
+    }
+    scroll_canvas = canvas;
+    scroll_canvas_size = size;
+    return true;
 }
 
-/// @brief Clear the page buffer
-void OledMenu::clearPageBuffer()
+/// @brief Get the number of times a page was rendered into the scroll canvas.
+/// @return Number of canvas renders.
+uint32_t OledMenu::getCanvasRenders()
 {
-    memset(&page_buffer_, '\0', page_buffer_size);
+    return canvas_renders;
 }
 
-/// @brief Acknowledge an error
-void OledMenu::acknowledgeError()
+/// @brief Make sure the scroll canvas holds the text being displayed, rendering it if needed
+/// @return True if the frame can be copied from the canvas, false if it has to be drawn directly
+bool OledMenu::prepareScrollCanvas()
 {
-    if (num_error > 0)
+    if (scroll_canvas == nullptr || buffer == nullptr || page_info == nullptr || highlightEnabled)
     {
-        num_error--;
+        return false;
     }
-    if (num_error == 0)
+    if (canvas_valid && canvas_source == buffer && canvas_hash == text_hash && canvas_font_index == line_font_index)
     {
-        OledMenu::error_message_display_override = false;
+        return true;
     }
-}
 
-/// @brief Check if there is an active error
-/// @return True if there is an active error, false otherwise
-bool OledMenu::hasActiveError()
-{
-    return OledMenu::error_message_display_override;
+    // Size the canvas for the longest line and all lines, with the top of the first line at y = 0
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    uint16_t chars = line_index.max_chars_on_line < OLED_MENU_MAX_LINE_CHARS ? line_index.max_chars_on_line : OLED_MENU_MAX_LINE_CHARS;
+    uint32_t width = static_cast<uint32_t>(chars) * metrics.width;
+    uint32_t height = line_index.num_lines == 0 ? 0 : (line_index.num_lines - 1) * metrics.line_spacing + metrics.ascent - metrics.descent;
+    uint32_t cols = (width + 7) / 8;
+    uint32_t rows = (height + 7) / 8;
+    canvas_valid = false;
+    if (cols == 0 || rows == 0 || cols > 255 || rows > 255 || cols * rows * 8 > scroll_canvas_size ||
+        (sizeof(u8g2_uint_t) == 1 && cols > 31))
+    {
+        return false;
+    }
+
+    renderScrollCanvas(cols, rows);
+    canvas_source = buffer;
+    canvas_hash = text_hash;
+    canvas_font_index = line_font_index;
+    canvas_valid = true;
+    return true;
 }
 
-/// @brief Show an error message
-/// @param fmt Format string for the error message
-/// @param ... Additional arguments for the format string
-/// @return Length of the error message
-int OledMenu::showErrorMessage(const char *fmt, ...)
+/// @brief Render the indexed text into the scroll canvas, one display sized window at a time
+/// @param cols Width of the canvas in tiles
+/// @param rows Height of the canvas in tiles
+void OledMenu::renderScrollCanvas(uint8_t cols, uint8_t rows)
 {
-    va_list args;
-    va_start(args, fmt);
-    int len = vsnprintf(NULL, 0, fmt, args);
-
-    if (len >= error_buffer_size)
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    uint8_t frame_cols = display_hal.getBufferTileWidth();
+    uint8_t frame_rows = display_hal.getBufferTileHeight();
+    const uint8_t *frame = display_hal.getBufferPtr();
+    int anchor_x = page_info->anchorX;
+    int anchor_y = page_info->anchorY;
+
+    // U8G2 only draws into the frame buffer, so the canvas is drawn there window by window and copied out
+    for (uint16_t wy = 0; wy < rows; wy += frame_rows)
     {
-        clearDisplayBuffer();
-        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
-        displayText(false);
-        va_end(args);
-        return -1;
+        for (uint16_t wx = 0; wx < cols; wx += frame_cols)
+        {
+            page_info->anchorX = -static_cast<int>(wx) * 8;
+            page_info->anchorY = metrics.ascent - static_cast<int>(wy) * 8;
+            display_hal.clearBuffer();
+            drawText(false, 0, maxHeight);
+
+            uint16_t copy_rows = (rows - wy < frame_rows) ? rows - wy : frame_rows;
+            uint16_t copy_cols = (cols - wx < frame_cols) ? cols - wx : frame_cols;
+            for (uint16_t r = 0; r < copy_rows; r++)
+            {
+                memcpy(scroll_canvas + ((wy + r) * cols + wx) * 8, frame + r * frame_cols * 8, copy_cols * 8);
+            }
+        }
     }
 
-    va_start(args, fmt);
-    vsnprintf(error_buffer_, len + 1, fmt, args);
-    va_end(args);
-
-    return len;
+    page_info->anchorX = anchor_x;
+    page_info->anchorY = anchor_y;
+    canvas_tile_cols = cols;
+    canvas_tile_rows = rows;
+    canvas_renders++;
 }
 
-/// @brief Check if a page is entered
-/// @return True if a page is entered, false otherwise
-bool OledMenu::isPageEntered()
+/// @brief Copy the window of the scroll canvas at the page anchor into the frame buffer
+void OledMenu::blitScrollCanvas()
 {
-    return page_entered;
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    uint8_t frame_cols = display_hal.getBufferTileWidth();
+    uint8_t frame_rows = display_hal.getBufferTileHeight();
+    uint8_t *frame = display_hal.getBufferPtr();
+    int canvas_width = canvas_tile_cols * 8;
+
+    // Canvas pixel of the top left display pixel
+    int src_x = -page_info->anchorX;
+    int src_y = metrics.ascent - page_info->anchorY;
+    int shift = ((src_y % 8) + 8) % 8;
+    int first_row = (src_y - shift) / 8;
+
+    for (uint8_t ty = 0; ty < frame_rows; ty++)
+    {
+        // A display tile row takes its top bits from one canvas tile row and the rest from the next
+        int upper = first_row + ty;
+        const uint8_t *top = (upper >= 0 && upper < canvas_tile_rows) ? scroll_canvas + upper * canvas_tile_cols * 8 : nullptr;
+        const uint8_t *bottom = (shift != 0 && upper + 1 >= 0 && upper + 1 < canvas_tile_rows) ? scroll_canvas + (upper + 1) * canvas_tile_cols * 8 : nullptr;
+        uint8_t *dst = frame + ty * frame_cols * 8;
+        for (uint16_t x = 0; x < frame_cols * 8; x++)
+        {
+            int sx = src_x + x;
+            uint8_t column = 0;
+            if (sx >= 0 && sx < canvas_width)
+            {
+                if (top != nullptr)
+                {
+                    column = top[sx] >> shift;
+                }
+                if (bottom != nullptr)
+                {
+                    column |= bottom[sx] << (8 - shift);
+                }
+            }
+            dst[x] = column;
+        }
+    }
 }
 
-/// @brief Exit the current page
-void OledMenu::exitCurrentPage()
+/// @brief Draw a single indexed line
+/// @param line Index of the line
+/// @param x X position of the line
+/// @param y Y position of the baseline
+void OledMenu::drawIndexedLine(uint16_t line, int x, int y)
 {
-    page_entered = false;
+    static_assert(OLED_MENU_MAX_LINE_CHARS <= 255, "Line lengths are indexed as uint8_t");
+    char line_text[OLED_MENU_MAX_LINE_CHARS + 1];
+    uint8_t len = line_index.length[line];
+    if (len > OLED_MENU_MAX_LINE_CHARS)
+    {
+        len = OLED_MENU_MAX_LINE_CHARS;
+    }
+    memcpy(line_text, line_index.source + line_index.start[line], len);
+    line_text[len] = '\0';
+    if (line_cache_memory != nullptr && drawCachedLine(line_text, len, x, y))
+    {
+        return;
+    }
+    display_hal.drawStr(x, y, line_text);
+    draw_calls++;
 }
 
-/// @brief Check if the current page is interactive
-/// @return True if the current page is interactive, false otherwise
-bool OledMenu::isCurrentPageInteractive()
+/// @brief Cache the bitmaps of drawn lines, so unchanged lines are copied instead of decoded from the font.
+/// @param memory Memory for the cache, nullptr to disable it.
+/// @param size Size of the cache memory, holds as many lines of the display width as fit.
+/// @return True if the line cache is active, false otherwise.
+bool OledMenu::setLineCache(uint8_t *memory, uint16_t size)
 {
-    return pages.getStoragePtr(current_page_displayed)->interactive;
+    // Bitmaps are copied byte by byte into a full frame buffer with vertical tiles
+    if (memory == nullptr || size == 0 || isPageBufferMode() ||
+        display_hal.getU8g2()->ll_hvline != u8g2_ll_hvline_vertical_top_lsb)
+    {
+        line_cache_memory = nullptr;
+        line_cache_size = 0;
+        line_cache_slots = 0;
+        return false;
+    }
+    line_cache_memory = memory;
+    line_cache_size = size;
+    line_cache_font = nullptr; // Slots are laid out on the first line drawn
+    line_cache_slots = 0;
+    return true;
 }
 
-/// @brief Enter the current page
-/// @return True if the page was entered successfully, false otherwise
-bool OledMenu::enterCurrentPage()
+/// @brief Get the number of lines copied from the line cache.
+/// @return Number of cache hits.
+uint32_t OledMenu::getLineCacheHits()
 {
-    if (isCurrentPageInteractive())
-    {
-        page_entered = true;
-        return true;
-    }
-    return false;
+    return line_cache_hits;
 }
 
-/// @brief Get the menu page info for a given page
-/// @param page Index of the page
-/// @return Pointer to the menu page info
-MENU::structs::menuPageInfo *OledMenu::getMenuPageInfo(uint8_t page)
+/// @brief Get the number of lines drawn from the font while the line cache was enabled.
+/// @return Number of cache misses.
+uint32_t OledMenu::getLineCacheMisses()
 {
-    return pages.getStoragePtr(page);
+    return line_cache_misses;
 }
 
-/// @brief Get the error page info for a given page
-/// @param page Index of the page
-/// @return Pointer to the error page info
-MENU::structs::errorPageInfo *OledMenu::getErrorPageInfo(uint8_t page)
+/// @brief Lay out the line cache slots for a font, emptying the cache
+/// @param font Font of the lines to cache
+void OledMenu::layoutLineCache(const uint8_t *font)
 {
-    return error_pages.getStoragePtr(page);
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    line_cache_font = font;
+    line_cache_bands = (metrics.ascent - metrics.descent + 7) / 8;
+
+    // Slot table first, aligned for its 32 bit members, then one display wide bitmap per slot
+    uintptr_t table = (reinterpret_cast<uintptr_t>(line_cache_memory) + 3) & ~static_cast<uintptr_t>(3);
+    uint16_t usable = line_cache_size - (table - reinterpret_cast<uintptr_t>(line_cache_memory));
+    uint16_t slot_size = sizeof(MENU::structs::lineCacheEntry) + maxWidth * line_cache_bands;
+    uint16_t slots = (table - reinterpret_cast<uintptr_t>(line_cache_memory) < line_cache_size) ? usable / slot_size : 0;
+    line_cache_slots = slots > 255 ? 255 : slots;
+    line_cache_entries = reinterpret_cast<MENU::structs::lineCacheEntry *>(table);
+    line_cache_data = reinterpret_cast<uint8_t *>(line_cache_entries + line_cache_slots);
+    memset(line_cache_entries, 0, line_cache_slots * sizeof(MENU::structs::lineCacheEntry));
 }
 
-/// @brief Set the text to be displayed and scrolled.
-/// @param txt The text to be displayed.
-void OledMenu::setText(const char *txt)
+/// @brief Draw a line through the line cache
+/// @param text Line text
+/// @param len Number of characters
+/// @param x X position of the line
+/// @param y Y position of the baseline
+/// @return True if the line was drawn, false if it has to be drawn directly
+bool OledMenu::drawCachedLine(const char *text, uint8_t len, int x, int y)
 {
-    size_t len = strlen(txt) + 1;
-    if (len > display_buffer_size)
+    // The font is part of the key, a new font starts with an empty cache
+    const uint8_t *font = display_hal.getU8g2()->font;
+    if (font != line_cache_font)
     {
-        clearDisplayBuffer();
-        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
-        displayText(false);
-        return;
+        layoutLineCache(font);
     }
-    strncpy(reinterpret_cast<char *>(display_buffer.allocate(len)), txt, len);
-    buffer = reinterpret_cast<char *>(display_buffer.allocate(len));
-    bufferSize = len;
-}
-
-/// @brief Set the text to be displayed and scrolled using an external buffer.
-/// @param buf The buffer to hold the text.
-/// @param bufSize The size of the buffer.
-void OledMenu::setText(char *buf, size_t bufSize)
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    int top = y - metrics.ascent;
+    int height = metrics.ascent - metrics.descent;
+    if (line_cache_slots == 0 || len == 0 || top < 0 || top + height > static_cast<int>(maxHeight))
+    {
+        return false;
+    }
+
+    uint32_t hash = hashBytes(2166136261UL, text, len);
+    uint8_t victim = 0;
+    for (uint8_t i = 0; i < line_cache_slots; i++)
+    {
+        MENU::structs::lineCacheEntry &entry = line_cache_entries[i];
+        if (entry.last_used != 0 && entry.hash == hash && entry.length == len && (!entry.clipped || entry.x == x))
+        {
+            // Hit: OR the bitmap into the frame buffer, as the transparent font mode would draw it
+            entry.last_used = ++line_cache_clock;
+            line_cache_hits++;
+            const uint8_t *bitmap = line_cache_data + i * maxWidth * line_cache_bands;
+            int first = x + entry.offset;
+            for (uint8_t band = 0; band < line_cache_bands; band++)
+            {
+                for (uint16_t c = 0; c < entry.width; c++)
+                {
+                    int col = first + c;
+                    if (col >= 0 && col < static_cast<int>(maxWidth))
+                    {
+                        orFrameColumn(col, top + band * 8, bitmap[band * maxWidth + c]);
+                    }
+                }
+            }
+            return true;
+        }
+        if (entry.last_used < line_cache_entries[victim].last_used)
+        {
+            victim = i;
+        }
+    }
+    line_cache_misses++;
+
+    // Capture a margin around the advance width for glyphs that reach past it
+    int start = x - 2;
+    int end = x + display_hal.getStrWidth(text) + 2;
+    bool clipped = start < 0 || end > static_cast<int>(maxWidth);
+    start = start < 0 ? 0 : start;
+    end = end > static_cast<int>(maxWidth) ? maxWidth : end;
+    if (end <= start)
+    {
+        return false;
+    }
+
+    // Only an empty area can be captured after drawing, anything below the line would end up in the bitmap
+    for (uint8_t band = 0; band < line_cache_bands; band++)
+    {
+        uint8_t rows = height - band * 8;
+        uint8_t mask = rows >= 8 ? 0xFF : (1 << rows) - 1;
+        for (int col = start; col < end; col++)
+        {
+            if (readFrameColumn(col, top + band * 8) & mask)
+            {
+                return false;
+            }
+        }
+    }
+
+    display_hal.drawStr(x, y, text);
+    draw_calls++;
+
+    MENU::structs::lineCacheEntry &entry = line_cache_entries[victim];
+    uint8_t *bitmap = line_cache_data + victim * maxWidth * line_cache_bands;
+    for (uint8_t band = 0; band < line_cache_bands; band++)
+    {
+        uint8_t rows = height - band * 8;
+        uint8_t mask = rows >= 8 ? 0xFF : (1 << rows) - 1;
+        for (int col = start; col < end; col++)
+        {
+            bitmap[band * maxWidth + col - start] = readFrameColumn(col, top + band * 8) & mask;
+        }
+    }
+    entry.hash = hash;
+    entry.last_used = ++line_cache_clock;
+    entry.x = x;
+    entry.length = len;
+    entry.width = end - start;
+    entry.offset = start - x;
+    entry.clipped = clipped;
+    return true;
+}
+
+/// @brief Read 8 pixel rows of a frame buffer column, starting at any row
+/// @param col Column
+/// @param top First pixel row
+/// @return Pixels, top row in bit 0
+uint8_t OledMenu::readFrameColumn(uint16_t col, int top)
 {
-    if (bufSize > display_buffer_size)
+    const uint8_t *frame = display_hal.getBufferPtr();
+    uint16_t stride = display_hal.getBufferTileWidth() * 8;
+    uint8_t tile_row = top / 8;
+    uint8_t shift = top % 8;
+    uint8_t bits = frame[tile_row * stride + col] >> shift;
+    if (shift != 0 && tile_row + 1 < display_hal.getBufferTileHeight())
     {
-        clearDisplayBuffer();
-        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
-        displayText(false);
-        return;
+        bits |= frame[(tile_row + 1) * stride + col] << (8 - shift);
     }
-    buffer = buf;
-    bufferSize = bufSize;
+    return bits;
 }
 
-/// @brief Manage the blinking state of the cursor.
-void OledMenu::manageCursorBlink()
+/// @brief Set 8 pixel rows of a frame buffer column, starting at any row
+/// @param col Column
+/// @param top First pixel row
+/// @param bits Pixels to set, top row in bit 0
+void OledMenu::orFrameColumn(uint16_t col, int top, uint8_t bits)
 {
-    unsigned long currentTime = millis();
-    if (blinkEnabled && (currentTime - lastBlinkTime >= blinkInterval))
+    uint8_t *frame = display_hal.getBufferPtr();
+    uint16_t stride = display_hal.getBufferTileWidth() * 8;
+    uint8_t tile_row = top / 8;
+    uint8_t shift = top % 8;
+    frame[tile_row * stride + col] |= bits << shift;
+    if (shift != 0 && tile_row + 1 < display_hal.getBufferTileHeight())
     {
-        blinkState = !blinkState;
-        lastBlinkTime = currentTime;
+        frame[(tile_row + 1) * stride + col] |= bits >> (8 - shift);
     }
 }
 
-/// @brief Blink the text at the cursor position.
-void OledMenu::blinkTextAtCursorPosition()
+/// @brief Calculate the fingerprint of the frame about to be drawn
+/// @param showCursor Whether the cursor is shown.
+/// @return FNV-1a hash of the text and the render state
+uint32_t OledMenu::frameFingerprint(bool showCursor)
 {
-    displayText(blinkState);
+    text_hash = hashText(buffer, bufferSize);
+    last_state_hash = renderStateHash(showCursor);
+    return hashBytes(text_hash, &last_state_hash, sizeof(last_state_hash));
 }
 
-/// @brief Set the number of display lines.
-/// @param num_lines Number of lines to display.
-void OledMenu::setNumberOfDisplayLines(int num_lines)
+/// @brief Calculate the fingerprint of the render state, without the text
+/// @param showCursor Whether the cursor is shown.
+/// @return FNV-1a hash of the buffer, page, anchor, cursor, font, highlight and blink phase
+uint32_t OledMenu::renderStateHash(bool showCursor)
 {
-    if (num_lines >= minLines && num_lines <= maxLines)
+    uint32_t hash = hashBytes(2166136261UL, &buffer, sizeof(buffer));
+    hash = hashBytes(hash, &page_info, sizeof(page_info));
+    if (page_info != nullptr)
     {
-        dispLines = num_lines;
+        hash = hashBytes(hash, &page_info->anchorX, sizeof(page_info->anchorX));
+        hash = hashBytes(hash, &page_info->anchorY, sizeof(page_info->anchorY));
+        hash = hashBytes(hash, &page_info->cursorX, sizeof(page_info->cursorX));
+        hash = hashBytes(hash, &page_info->cursorY, sizeof(page_info->cursorY));
     }
-    else if (num_lines < minLines)
+    uint8_t state[] = {static_cast<uint8_t>(dispLines), highlightEnabled, showCursor};
+    return hashBytes(hash, state, sizeof(state));
+}
+
+/// @brief Hash a text buffer up to its terminator
+/// @param text Text to hash
+/// @param size Size of the text buffer
+/// @return FNV-1a hash of the text
+uint32_t OledMenu::hashText(const char *text, size_t size)
+{
+    uint32_t hash = 2166136261UL; // FNV-1a offset basis
+    if (text != nullptr)
     {
-        dispLines = minLines;
+        hash = hashBytes(hash, text, strnlen(text, size));
     }
-    else if (num_lines > maxLines)
+    return hash;
+}
+
+/// @brief Add bytes to an FNV-1a hash
+/// @param hash Hash to add to
+/// @param data Bytes to hash
+/// @param len Number of bytes
+/// @return Updated hash
+uint32_t OledMenu::hashBytes(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < len; i++)
     {
-        dispLines = maxLines;
+        hash ^= bytes[i];
+        hash *= 16777619UL;
     }
+    return hash;
 }
 
-/// @brief Get the number of display lines.
-/// @return Number of lines to display.
-int OledMenu::getNumberOfDisplayLines()
+/// @brief Force the next frame to be drawn even if its content did not change
+void OledMenu::invalidateDisplay()
 {
-    return dispLines;
+    frame_hash_valid = false;
 }
 
-/// @brief Set the font size based on the number of lines to be displayed.
-void OledMenu::setFontSizeForLineLimits()
+/// @brief Get the number of frames drawn and flushed.
+/// @return Number of frames drawn.
+uint32_t OledMenu::getFramesDrawn()
 {
-    uint8_t fontPixelHeight = maxHeight / dispLines;
-    if (fontPixelHeight >= fontMinPixelHeight && fontPixelHeight <= fontMaxPixelHeight)
+    return frames_drawn;
+}
+
+/// @brief Get the number of unchanged frames that were skipped.
+/// @return Number of frames skipped.
+uint32_t OledMenu::getFramesSkipped()
+{
+    return frames_skipped;
+}
+
+/// @brief Get the number of U8G2 draw calls made while rendering frames.
+/// @return Number of draw calls.
+uint32_t OledMenu::getDrawCalls()
+{
+    return draw_calls;
+}
+
+/// @brief Send the frame buffer to the display, only changed tiles if dirty tile tracking is enabled
+void OledMenu::flushDisplay()
+{
+    if (mirror_out != nullptr)
     {
-        // Ensure the lookup table is defined and within bounds
-        uint8_t index = fontPixelHeight - fontMinPixelHeight;
-        if (index < sizeof(u8g2_font_lookup_table) / sizeof(u8g2_font_lookup_table[0]))
+        writeMirrorFrame();
+    }
+
+    if (async_flush)
+    {
+        // A frame still in flight is replaced by this one, rows already sent are sent again if needed
+        if (flush_pending_rows != 0)
         {
-            display_hal.setFont(u8g2_font_lookup_table[index]);
+            frames_coalesced++;
         }
-        else
+        flush_pending_rows = allTileRowsMask();
+        return;
+    }
+
+    OLED_MENU_TRACE_BEGIN(flush);
+    OLED_MENU_STAGE_BEGIN(flush);
+    if (!dirty_tile_tracking)
+    {
+        display_hal.sendBuffer();
+    }
+    else
+    {
+        uint8_t tile_rows = display_hal.getBufferTileHeight();
+        for (uint8_t ty = 0; ty < tile_rows; ty++)
         {
-            // Handle out-of-bounds index
-            display_hal.setFont(u8g2_font_helvB08_tf); // Default font as fallback
+            flushTileRow(ty);
         }
     }
-    else
+    OLED_MENU_STAGE_END(flush, MENU::structs::RENDER_STAGE::FLUSH);
+    OLED_MENU_TRACE_END(flush, MENU::structs::TRACE_FLUSH, display_hal.getBufferTileHeight());
+}
+
+/// @brief Send one tile row of the frame buffer to the display, only changed tiles if dirty tile tracking is enabled
+/// @param ty Index of the tile row
+void OledMenu::flushTileRow(uint8_t ty)
+{
+    uint8_t tile_cols = display_hal.getBufferTileWidth();
+    if (!dirty_tile_tracking)
+    {
+        display_hal.updateDisplayArea(0, ty, tile_cols, 1);
+        tiles_sent += tile_cols;
+        return;
+    }
+
+    uint8_t *frame = display_hal.getBufferPtr();
+    uint16_t row_offset = ty * tile_cols * 8;
+    uint8_t tx = 0;
+    while (tx < tile_cols)
     {
-        // Handle fontPixelHeight out of range
-        display_hal.setFont(u8g2_font_helvB08_tf); // Default font as fallback
+        if (!isTileDirty(ty, row_offset + tx * 8))
+        {
+            tiles_skipped++;
+            tx++;
+            continue;
+        }
+
+        // Send consecutive dirty tiles of this row as one area
+        uint8_t run_start = tx;
+        while (tx < tile_cols && isTileDirty(ty, row_offset + tx * 8))
+        {
+            tx++;
+        }
+        uint8_t run_length = tx - run_start;
+        memcpy(tile_shadow_buffer + row_offset + run_start * 8, frame + row_offset + run_start * 8, run_length * 8);
+        display_hal.updateDisplayArea(run_start, ty, run_length, 1);
+        tiles_sent += run_length;
     }
+    tile_shadow_stale_rows &= ~(1UL << ty);
 }
 
-/// @brief Get the current X position of the cursor.
-/// @return The X position of the cursor.
-int OledMenu::getCursorXPosition()
+/// @brief Check if a tile differs from the last frame sent
+/// @param ty Index of the tile row
+/// @param offset Byte offset of the tile in the frame buffer
+/// @return True if the tile has changed, false otherwise
+bool OledMenu::isTileDirty(uint8_t ty, uint16_t offset)
 {
-    return page_info->cursorX;
+    if (tile_shadow_stale_rows & (1UL << ty))
+    {
+        return true;
+    }
+    return memcmp(display_hal.getBufferPtr() + offset, tile_shadow_buffer + offset, 8) != 0;
 }
 
-/// @brief Get the current Y position of the cursor.
-/// @return The Y position of the cursor.
-int OledMenu::getCursorYPosition()
+/// @brief Get a bit mask with one bit set for every tile row of the frame buffer
+/// @return Tile row mask
+uint32_t OledMenu::allTileRowsMask()
 {
-    return page_info->cursorY;
+    uint8_t tile_rows = display_hal.getBufferTileHeight();
+    return tile_rows >= 32 ? 0xFFFFFFFFUL : (1UL << tile_rows) - 1;
 }
 
-/// @brief Get the width of a character in the current font.
-/// @return The width of a character.
-int OledMenu::getFontCharacterWidth()
+/// @brief Write the tiles that changed since the last mirror frame to the mirror stream
+void OledMenu::writeMirrorFrame()
 {
-    return display_hal.getMaxCharWidth();
+    uint8_t *frame = display_hal.getBufferPtr();
+    uint8_t tile_cols = display_hal.getBufferTileWidth();
+    uint8_t tile_rows = display_hal.getBufferTileHeight();
+    bool keyframe = mirror_keyframe_due ||
+                    (mirror_keyframe_interval > 0 && mirror_frames_since_key >= mirror_keyframe_interval);
+    bool started = false;
+
+    for (uint8_t ty = 0; ty < tile_rows; ty++)
+    {
+        uint16_t row_offset = ty * tile_cols * 8;
+        uint8_t tx = 0;
+        while (tx < tile_cols)
+        {
+            if (!keyframe && memcmp(frame + row_offset + tx * 8, mirror_shadow + row_offset + tx * 8, 8) == 0)
+            {
+                tx++;
+                continue;
+            }
+
+            // Consecutive changed tiles of this row form one run, a full frame sends each row as one run
+            uint8_t run_start = tx;
+            while (tx < tile_cols &&
+                   (keyframe || memcmp(frame + row_offset + tx * 8, mirror_shadow + row_offset + tx * 8, 8) != 0))
+            {
+                tx++;
+            }
+
+            if (!started)
+            {
+                static const uint8_t sync[2] = {0xA5, 0x5A};
+                mirror_out->write(sync, sizeof(sync));
+                mirror_bytes += sizeof(sync);
+                mirror_checksum = 2166136261UL; // The hash covers the frame from the type on
+                uint8_t layout = display_hal.getU8g2()->ll_hvline == u8g2_ll_hvline_vertical_top_lsb ? 0 : 1;
+                uint8_t header[6] = {static_cast<uint8_t>(keyframe ? 'K' : 'D'), static_cast<uint8_t>(mirror_sequence & 0xFF),
+                                     static_cast<uint8_t>(mirror_sequence >> 8), tile_cols, tile_rows, layout};
+                writeMirrorBytes(header, sizeof(header));
+                started = true;
+            }
+
+            uint16_t offset = row_offset + run_start * 8;
+            uint16_t length = (tx - run_start) * 8;
+            uint8_t run[3] = {run_start, ty, static_cast<uint8_t>(tx - run_start)};
+            writeMirrorBytes(run, sizeof(run));
+            writeMirrorPacked(frame + offset, length);
+            memcpy(mirror_shadow + offset, frame + offset, length);
+        }
+    }
+
+    if (!started)
+    {
+        return;
+    }
+
+    uint8_t end = 0xFF;
+    writeMirrorBytes(&end, 1);
+    uint8_t checksum[4] = {static_cast<uint8_t>(mirror_checksum), static_cast<uint8_t>(mirror_checksum >> 8),
+                           static_cast<uint8_t>(mirror_checksum >> 16), static_cast<uint8_t>(mirror_checksum >> 24)};
+    mirror_out->write(checksum, sizeof(checksum));
+    mirror_bytes += sizeof(checksum);
+
+    mirror_sequence++;
+    mirror_frames_since_key = keyframe ? 0 : mirror_frames_since_key + 1;
+    mirror_keyframe_due = false;
 }
 
-/// @brief Set the display anchor position.
-/// @param x X position of the anchor.
-/// @param y Y position of the anchor.
-void OledMenu::setDisplayAnchor(int x, int y)
+/// @brief Write bytes of a mirror frame and add them to its checksum
+/// @param data Bytes to write
+/// @param len Number of bytes
+void OledMenu::writeMirrorBytes(const uint8_t *data, uint16_t len)
 {
-    page_info->anchorX = x;
-    page_info->anchorY = y + display_hal.getMaxCharHeight();
+    mirror_out->write(data, len);
+    mirror_checksum = hashBytes(mirror_checksum, data, len);
+    mirror_bytes += len;
 }
 
-/// @brief Get the anchor position.
-/// @param x X position of the anchor.
-/// @param y Y position of the anchor.
-void OledMenu::getDisplayAnchor(int &x, int &y)
+/// @brief Write bytes of a mirror frame PackBits encoded
+/// @param data Bytes to encode
+/// @param len Number of bytes
+void OledMenu::writeMirrorPacked(const uint8_t *data, uint16_t len)
 {
-    x = page_info->anchorX;
-    y = page_info->anchorY;
+    uint16_t i = 0;
+    while (i < len)
+    {
+        // Three or more equal bytes are sent as a repeat, blank areas of the display shrink to two bytes
+        uint16_t repeat = 1;
+        while (i + repeat < len && repeat < 128 && data[i + repeat] == data[i])
+        {
+            repeat++;
+        }
+        if (repeat >= 3)
+        {
+            uint8_t packed[2] = {static_cast<uint8_t>(257 - repeat), data[i]};
+            writeMirrorBytes(packed, sizeof(packed));
+            i += repeat;
+            continue;
+        }
+
+        // Everything up to the next repeat is sent as literal bytes
+        uint16_t start = i;
+        while (i < len && i - start < 128)
+        {
+            if (i + 2 < len && data[i] == data[i + 1] && data[i] == data[i + 2])
+            {
+                break;
+            }
+            i++;
+        }
+        uint8_t count = static_cast<uint8_t>(i - start - 1);
+        writeMirrorBytes(&count, 1);
+        writeMirrorBytes(data + start, i - start);
+    }
 }
 
-/// @brief Set the cursor position.
-/// @param x X position of the cursor.
-/// @param y Y position of the cursor.
-void OledMenu::setCursorPosition(int x, int y)
+/// @brief Enable or disable the asynchronous flush.
+/// @param enable True to queue frames in refreshDisplay() and send them from service().
+/// @param rows_per_service Maximum number of tile rows sent per service() call.
+/// @param budget_us Time budget of a service() call in microseconds, 0 for no budget.
+/// @return True if the asynchronous flush is active, false otherwise.
+bool OledMenu::setAsyncFlush(bool enable, uint8_t rows_per_service, uint16_t budget_us)
 {
-    page_info->cursorX = x;
-    page_info->cursorY = y;
+    if (!enable || isPageBufferMode() || display_hal.getBufferTileHeight() > 32)
+    {
+        if (async_flush)
+        {
+            // Send what is still queued before going back to synchronous flushes
+            async_flush = false;
+            flush_rows_per_service = 0xFF;
+            flush_budget_us = 0;
+            service();
+        }
+        flush_pending_rows = 0;
+        return false;
+    }
+
+    async_flush = true;
+    flush_rows_per_service = rows_per_service > 0 ? rows_per_service : 1;
+    flush_budget_us = budget_us;
+    return true;
 }
 
-/// @brief Get cursor position.
-/// @param x X position of the cursor.
-/// @param y Y position of the cursor.
-void OledMenu::getCursorPosition(int &x, int &y)
+/// @brief Send queued tile rows to the display within the configured limits.
+/// @return Number of tile rows sent.
+uint8_t OledMenu::service()
 {
-    x = page_info->cursorX;
-    y = page_info->cursorY;
+    if (flush_pending_rows == 0)
+    {
+        return 0;
+    }
+
+    unsigned long start = micros();
+    uint8_t tile_rows = display_hal.getBufferTileHeight();
+    uint8_t rows_sent = 0;
+    while (flush_pending_rows != 0 && rows_sent < flush_rows_per_service)
+    {
+        // At least one row is sent per call so the frame always makes progress
+        if (rows_sent > 0 && flush_budget_us > 0 && micros() - start >= flush_budget_us)
+        {
+            break;
+        }
+
+        uint8_t ty = flush_next_row;
+        flush_next_row = (flush_next_row + 1) % tile_rows;
+        if (flush_pending_rows & (1UL << ty))
+        {
+            flushTileRow(ty);
+            flush_pending_rows &= ~(1UL << ty);
+            rows_sent++;
+        }
+    }
+#if defined(OLED_MENU_ENABLE_STATS)
+    // One FLUSH sample per frame, like a synchronous flush. Rows sent for a frame that was replaced while in
+    // flight count towards the frame replacing it.
+    flush_frame_us += micros() - start;
+    if (flush_pending_rows == 0)
+    {
+        recordStageTime(MENU::structs::RENDER_STAGE::FLUSH, flush_frame_us);
+        flush_frame_us = 0;
+    }
+#endif
+#if defined(OLED_MENU_ENABLE_TRACE)
+    recordTrace(MENU::structs::TRACE_SERVICE, start, micros() - start, rows_sent, false);
+#endif
+    return rows_sent;
 }
 
-void OledMenu::scroll(int x, int y)
+/// @brief Check if a frame is still being sent by service().
+/// @return True if tile rows are still queued, false otherwise.
+bool OledMenu::isFlushInProgress()
 {
-    // Calculate text width and height based on max_chars_on_line and num_lines
-    int textWidth = getFontCharacterWidth() * page_info->max_chars_on_line;
-    int textHeight = display_hal.getMaxCharHeight() * page_info->num_lines;
+    return flush_pending_rows != 0;
+}
 
-    // Calculate new cursor position
-    int newCursorX = page_info->cursorX + x;
-    int newCursorY = page_info->cursorY + y;
+/// @brief Get the number of frames that replaced a frame still in flight.
+/// @return Number of coalesced frames.
+uint32_t OledMenu::getFramesCoalesced()
+{
+    return frames_coalesced;
+}
 
-    // Ensure cursor stays within the bounds of the display
-    if (newCursorX < 0)
+/// @brief Enable or disable dirty tile tracking.
+/// @param enable True to flush only the 8x8 tiles that changed since the last frame.
+/// @return True if dirty tile tracking is active, false otherwise.
+bool OledMenu::setDirtyTileTracking(bool enable)
+{
+    if (!enable)
     {
-        newCursorX = 0;
+        dirty_tile_tracking = false;
+        return false;
     }
-    else if (newCursorX > maxWidth - getFontCharacterWidth())
+
+    // Page buffer constructors only hold a strip of the display, nothing to compare against
+    uint8_t tile_rows = display_hal.getBufferTileHeight();
+    if (isPageBufferMode())
     {
-        newCursorX = maxWidth - getFontCharacterWidth();
+        dirty_tile_tracking = false;
+        return false;
     }
 
-    if (newCursorY < 0)
+    uint16_t size = tile_rows * display_hal.getBufferTileWidth() * 8;
+    if (tile_shadow_buffer == nullptr || tile_shadow_size != size)
     {
-        newCursorY = 0;
+        delete[] tile_shadow_buffer;
+        tile_shadow_buffer = new uint8_t[size];
+        tile_shadow_size = size;
     }
-    else if (newCursorY > maxHeight - display_hal.getMaxCharHeight())
+    tile_shadow_stale_rows = allTileRowsMask(); // First frame is sent in full
+    frame_hash_valid = false;
+    dirty_tile_tracking = true;
+    return true;
+}
+
+/// @brief Enable or disable word wrap.
+/// @param cache Layout cache to wrap page text at spaces to the display width, nullptr to clip long lines.
+/// @return True if word wrap is active, false otherwise.
+bool OledMenu::setWordWrap(MENU::structs::wrapCache *cache)
+{
+    if (cache != nullptr)
     {
-        newCursorY = maxHeight - display_hal.getMaxCharHeight();
+        // Nothing is known about the memory, measure the font and lay out all lines again
+        cache->font = nullptr;
+        cache->num_lines = 0;
     }
+    wrap_cache = cache;
+    line_index.source = nullptr; // Lines are indexed again for the next frame
+    canvas_valid = false;        // The scroll canvas holds the lines of the old layout
+    frame_hash_valid = false;
+    return wrap_cache != nullptr;
+}
 
-    // Update cursor position
-    page_info->cursorX = newCursorX;
-    page_info->cursorY = newCursorY;
+/// @brief Get the number of tiles flushed to the display.
+/// @return Number of tiles sent.
+uint32_t OledMenu::getTilesSent()
+{
+    return tiles_sent;
+}
 
-    // Calculate offsets if cursor is at the edge
-    int offsetX = page_info->anchorX;
-    int offsetY = page_info->anchorY;
+/// @brief Get the number of unchanged tiles that were not flushed.
+/// @return Number of tiles skipped.
+uint32_t OledMenu::getTilesSkipped()
+{
+    return tiles_skipped;
+}
+
+/// @brief Reset the tile sent and skipped counters.
+void OledMenu::resetTileCounters()
+{
+    tiles_sent = 0;
+    tiles_skipped = 0;
+}
 
-    if (newCursorX == 0 || newCursorX == maxWidth - getFontCharacterWidth())
+/// @brief Write the changed tiles of every frame to a stream, to mirror the display on a host.
+/// @param out Stream to write to, for example Serial or a WiFiClient, nullptr to disable the mirror.
+/// @param keyframe_interval Number of frames between two full frames, 0 to write only the first in full.
+/// @return True if the mirror is active, false otherwise.
+bool OledMenu::setMirror(Print *out, uint16_t keyframe_interval)
+{
+    // Page buffer constructors only hold a strip of the display, there is no frame to compare
+    if (out == nullptr || isPageBufferMode())
     {
-        offsetX = (maxWidth - textWidth) / 2 + x;
+        mirror_out = nullptr;
+        return false;
     }
 
-    if (newCursorY == 0 || newCursorY == maxHeight - display_hal.getMaxCharHeight())
+    uint16_t size = display_hal.getBufferTileHeight() * display_hal.getBufferTileWidth() * 8;
+    if (mirror_shadow == nullptr || mirror_shadow_size != size)
     {
-        offsetY = (maxHeight - textHeight) / 2 + y;
+        delete[] mirror_shadow;
+        mirror_shadow = new uint8_t[size];
+        mirror_shadow_size = size;
     }
+    mirror_out = out;
+    mirror_keyframe_interval = keyframe_interval;
+    mirror_keyframe_due = true; // The host starts from the first frame in full
+    frame_hash_valid = false;
+    return true;
+}
 
-    // Store offsets for later use in rendering
-    page_info->anchorX = offsetX;
-    page_info->anchorY = offsetY;
+/// @brief Write the next mirror frame in full, for example after the host reconnected.
+void OledMenu::requestMirrorKeyframe()
+{
+    mirror_keyframe_due = true;
+    frame_hash_valid = false;
 }
 
-/// @brief Render text for the current menu page
-void OledMenu::renderMenuPageText()
+/// @brief Get the number of bytes written to the mirror.
+/// @return Number of mirror bytes.
+uint32_t OledMenu::getMirrorBytes()
 {
-    page_info = getMenuPageInfo(current_page_displayed);
-    if (page_info->callback)
-    {
-        page_info->callback(page_info);
-    }
-    buffer = page_info->buffer;
-    bufferSize = page_info->needs_buffer_size;
-    displayText(false);
+    return mirror_bytes;
 }
 
-/// @brief Render text for the current error page
-void OledMenu::renderErrorPageText()
+/// @brief Add a page to the menu
+/// @param type Type of the page
+/// @param interactive Whether the page is interactive
+/// @param callback Callback function for the page
+/// @param page_buffer Buffer for the page content
+/// @param target_buffer_size Size of the page buffer
+/// @return True if the page was added successfully, false otherwise
+bool OledMenu::addMenuPage(MENU::structs::PAGE_TYPE type, bool interactive, MENU::structs::menu_callback callback, char *page_buffer, uint16_t target_buffer_size)
 {
-    MENU::structs::errorPageInfo *error_page_info = getErrorPageInfo(current_page_displayed);
-    buffer = error_page_info->buffer;
-    bufferSize = error_page_info->needs_buffer_size;
-    displayText(false);
+    if (num_pages >= max_pages)
+    {
+        return false;
+    }
+
+    if (page_buffer == nullptr || target_buffer_size == 0)
+    {
+        page_buffer = page_buffer_;
+        target_buffer_size = page_buffer_size;
+    }
+
+    MENU::structs::menuPageInfo page_info(type, interactive, callback, page_buffer, target_buffer_size);
+    page_info.callback(&page_info); // Call the callback function to populate the page buffer
+
+    // Check if the buffer size is sufficient
+    if (page_info.needs_buffer_size > target_buffer_size)
+    {
+        clearDisplayBuffer();
+        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
+        displayText(false);
+        return false;
+    }
+
+    MENU::structs::menuPageInfo *page = &pages[num_pages];
+    *page = page_info;
+    buildLineIndex(page_buffer, target_buffer_size, hashText(page_buffer, target_buffer_size));
+    page->num_lines = line_index.num_lines;
+    page->max_chars_on_line = line_index.max_chars_on_line;
+    num_pages++;
+    return true;
+}
+
+/// @brief Add a template page whose fields are bound to variables
+/// @param interactive Whether the page is interactive
+/// @param layout Static page text, every "{}" is replaced by the next field
+/// @param fields Bound fields, in layout order, must stay valid while the page exists
+/// @param num_fields Number of fields
+/// @param page_buffer Buffer for the page content, nullptr to use the shared page buffer
+/// @param target_buffer_size Size of the page buffer
+/// @return True if the page was added successfully, false otherwise
+bool OledMenu::addTemplatePage(bool interactive, const char *layout, MENU::structs::templateField *fields, uint8_t num_fields,
+                               char *page_buffer, uint16_t target_buffer_size)
+{
+    if (num_pages >= max_pages || layout == nullptr || num_fields > OLED_MENU_MAX_TEMPLATE_FIELDS)
+    {
+        return false;
+    }
+
+    if (page_buffer == nullptr || target_buffer_size == 0)
+    {
+        page_buffer = page_buffer_;
+        target_buffer_size = page_buffer_size;
+    }
+
+    MENU::structs::menuPageInfo page_info(MENU::structs::PAGE_TYPE::USER, interactive, nullptr, page_buffer, target_buffer_size);
+    page_info.fields = fields;
+    page_info.num_fields = num_fields;
+    page_info.layout = layout;
+    if (!expandTemplateLayout(&page_info))
+    {
+        return false;
+    }
+    updateTemplateFields(&page_info, true);
+
+    MENU::structs::menuPageInfo *page = &pages[num_pages];
+    *page = page_info;
+    buildLineIndex(page_buffer, target_buffer_size, hashText(page_buffer, target_buffer_size));
+    page->num_lines = line_index.num_lines;
+    page->max_chars_on_line = line_index.max_chars_on_line;
+    num_pages++;
+    return true;
+}
+
+/// @brief Add a page that streams a document larger than RAM through a reader, one window at a time
+/// @param interactive Whether the page is interactive
+/// @param document Streamed document, must stay valid while the page exists
+/// @param page_buffer Buffer for the visible window, nullptr to use the shared page buffer
+/// @param target_buffer_size Size of the page buffer
+/// @return True if the page was added successfully, false otherwise
+bool OledMenu::addStreamPage(bool interactive, MENU::structs::streamDocument *document, char *page_buffer, uint16_t target_buffer_size)
+{
+    if (num_pages >= max_pages || document == nullptr || document->reader == nullptr || document->checkpoints == nullptr ||
+        document->max_checkpoints == 0 || document->checkpoint_interval == 0)
+    {
+        return false;
+    }
+
+    if (page_buffer == nullptr || target_buffer_size == 0)
+    {
+        page_buffer = page_buffer_;
+        target_buffer_size = page_buffer_size;
+    }
+    if (target_buffer_size < 2)
+    {
+        return false;
+    }
+
+    document->checkpoints[0] = 0;
+    document->num_checkpoints = 1;
+    document->end_known = false;
+
+    // The window is only read again when the document scrolls or a refresh is requested
+    MENU::structs::menuPageInfo page_info(MENU::structs::PAGE_TYPE::USER, interactive, nullptr, page_buffer, target_buffer_size);
+    page_info.stream = document;
+    page_info.refresh_policy = MENU::structs::REFRESH_POLICY::ON_DEMAND;
+    fillStreamWindow(&page_info);
+
+    MENU::structs::menuPageInfo *page = &pages[num_pages];
+    *page = page_info;
+    buildLineIndex(page_buffer, target_buffer_size, hashText(page_buffer, target_buffer_size));
+    page->num_lines = line_index.num_lines;
+    page->max_chars_on_line = line_index.max_chars_on_line;
+    num_pages++;
+    return true;
+}
+
+/// @brief Add a page that shows the newest lines of a log
+/// @param interactive Whether the page is interactive
+/// @param log Lines of the log, must stay valid while the page exists
+/// @param page_buffer Buffer for the visible lines, nullptr to use the shared page buffer
+/// @param target_buffer_size Size of the page buffer
+/// @return True if the page was added successfully, false otherwise
+bool OledMenu::addLogPage(bool interactive, MENU::structs::logPage *log, char *page_buffer, uint16_t target_buffer_size)
+{
+    if (num_pages >= max_pages || log == nullptr || log->lines == nullptr || log->capacity == 0 || log->line_size < 2)
+    {
+        return false;
+    }
+
+    if (page_buffer == nullptr || target_buffer_size == 0)
+    {
+        page_buffer = page_buffer_;
+        target_buffer_size = page_buffer_size;
+    }
+
+    // The window is only built again when a line is appended or the log is scrolled
+    MENU::structs::menuPageInfo page_info(MENU::structs::PAGE_TYPE::USER, interactive, nullptr, page_buffer, target_buffer_size);
+    page_info.log = log;
+    page_info.refresh_policy = MENU::structs::REFRESH_POLICY::ON_DEMAND;
+    buildLogWindow(&page_info);
+
+    MENU::structs::menuPageInfo *page = &pages[num_pages];
+    *page = page_info;
+    buildLineIndex(page_buffer, target_buffer_size, hashText(page_buffer, target_buffer_size));
+    page->num_lines = line_index.num_lines;
+    page->max_chars_on_line = line_index.max_chars_on_line;
+    num_pages++;
+    return true;
+}
+
+/// @brief Append a line to a log, overwriting the oldest line when the log is full
+/// @param log Log to append to
+/// @param fmt Format string of the line, a line break ends the line
+/// @param ... Additional arguments for the format string
+/// @return True if the line was appended, false if the log has no storage
+bool OledMenu::appendLog(MENU::structs::logPage *log, const char *fmt, ...)
+{
+    if (log == nullptr || log->lines == nullptr || log->capacity == 0 || log->line_size == 0)
+    {
+        return false;
+    }
+
+    char *slot = log->lines + log->head * log->line_size;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(slot, log->line_size, fmt, args);
+    va_end(args);
+    char *line_break = strchr(slot, '\n');
+    if (line_break != nullptr)
+    {
+        *line_break = '\0';
+    }
+
+    log->head = (log->head + 1) % log->capacity;
+    if (log->count < log->capacity)
+    {
+        log->count++;
+    }
+    if (log->scrollback > 0 && log->scrollback < log->count)
+    {
+        log->scrollback++; // Scrolled back, the lines in view stay in view until they leave the ring
+    }
+    log->sequence++;
+    return true;
+}
+
+/// @brief Load the menu pages from a table of page definitions stored in flash
+/// @param table Page definitions, in PROGMEM
+/// @param count Number of page definitions
+/// @param page_buffers Buffer split into the page buffers, see OLED_MENU_TABLE_BUFFERS
+/// @param page_buffers_size Size of page_buffers
+/// @return True if all pages were loaded, false otherwise
+bool OledMenu::loadMenuTable(const MENU::structs::menuPageDef *table, uint8_t count, char *page_buffers, size_t page_buffers_size)
+{
+    size_t offset = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        MENU::structs::menuPageDef def;
+        memcpy_P(&def, &table[i], sizeof(def));
+
+        if (num_pages >= max_pages || offset + def.buffer_size > page_buffers_size)
+        {
+            return false;
+        }
+
+        char *page_buffer = page_buffers + offset;
+        offset += def.buffer_size;
+
+        MENU::structs::menuPageInfo *page = &pages[num_pages];
+        *page = MENU::structs::menuPageInfo(def.type, def.interactive, def.callback, page_buffer, def.buffer_size);
+        if (def.static_text != nullptr)
+        {
+            strncpy_P(page_buffer, def.static_text, def.buffer_size);
+            page_buffer[def.buffer_size - 1] = '\0';
+            page->needs_buffer_size = strlen(page_buffer) + 1;
+            // The text does not change, index it now so line navigation works before the first render
+            buildLineIndex(page_buffer, def.buffer_size, hashText(page_buffer, def.buffer_size));
+            page->num_lines = line_index.num_lines;
+            page->max_chars_on_line = line_index.max_chars_on_line;
+        }
+        else
+        {
+            page_buffer[0] = '\0';
+            page->needs_buffer_size = def.buffer_size;
+        }
+        num_pages++;
+    }
+    return true;
+}
+
+/// @brief Add an error page to the menu
+/// @param callback Callback function for the error page
+/// @return True if the error page was added successfully, false otherwise
+bool OledMenu::addErrorPage(MENU::structs::menu_callback callback)
+{
+    if (num_error_pages >= max_error_pages)
+    {
+        return false;
+    }
+
+    MENU::structs::errorPageInfo page_info(MENU::structs::PAGE_TYPE::ERROR, false, callback, error_buffer_, error_buffer_size);
+    page_info.callback(&page_info); // Call the callback function to populate the page buffer
+
+    // Check if the buffer size is sufficient
+    if (page_info.needs_buffer_size > error_buffer_size)
+    {
+        clearDisplayBuffer();
+        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
+        displayText(false);
+        return false;
+    }
+
+    MENU::structs::errorPageInfo *page = &error_pages[num_error_pages];
+    *page = page_info;
+    buildLineIndex(error_buffer_, error_buffer_size, hashText(error_buffer_, error_buffer_size));
+    page->num_lines = line_index.num_lines;
+    page->max_chars_on_line = line_index.max_chars_on_line;
+    num_error_pages++;
+    return true;
+}
+
+/// @brief Refresh the display
+void OledMenu::refreshDisplay()
+{
+    OLED_MENU_TRACE_BEGIN(refresh);
+    text_arena.reset(); // Transient text of the previous frame is no longer needed
+    processInputs();
+    if (display_connected)
+    {
+        if (idle_policy && applyIdlePolicy())
+        {
+            // Asleep: no callbacks and no drawing, the panel keeps the last frame
+            return;
+        }
+        if (error_message_display_override)
+        {
+            OLED_MENU_TRACE_BEGIN(render);
+            renderErrorPageText();
+            OLED_MENU_TRACE_END(render, MENU::structs::TRACE_RENDER_ERROR, num_error);
+        }
+        else
+        {
+            OLED_MENU_TRACE_BEGIN(render);
+            renderMenuPageText();
+            OLED_MENU_TRACE_END(render, MENU::structs::TRACE_RENDER_PAGE, current_page_displayed);
+        }
+        manageCursorBlink();
+    }
+    OLED_MENU_TRACE_END(refresh, MENU::structs::TRACE_REFRESH, current_page_displayed);
+}
+
+/// @brief Move to the next page
+void OledMenu::moveToNextPage()
+{
+    movePageBy(1);
+}
+
+/// @brief Move to the previous page
+void OledMenu::moveToPreviousPage()
+{
+    movePageBy(-1);
+}
+
+/// @brief Move up an item in the menu
+void OledMenu::moveUpMenuItem()
+{
+    moveMenuItemBy(-1);
+}
+
+/// @brief Move down an item in the menu
+void OledMenu::moveDownMenuItem()
+{
+    moveMenuItemBy(1);
+}
+
+/// @brief Move a number of pages forward or back, wrapping around
+/// @param delta Number of pages to move, negative to move back
+void OledMenu::movePageBy(int delta)
+{
+    idle_activity = true;
+    if (num_pages == 0)
+    {
+        return;
+    }
+    int page = (current_page_displayed + delta) % num_pages;
+    if (page < 0)
+    {
+        page += num_pages;
+    }
+    current_page_displayed = page;
+    OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_MOVE_PAGE, current_page_displayed);
+}
+
+/// @brief Move a number of items down or up in the current page, wrapping around
+/// @param delta Number of items to move, negative to move up
+void OledMenu::moveMenuItemBy(int delta)
+{
+    idle_activity = true;
+    page_info = getMenuPageInfo(current_page_displayed);
+    if (page_info != nullptr && page_info->log != nullptr)
+    {
+        // Log pages scroll back towards older lines, down to the newest line follows the tail again
+        MENU::structs::logPage *log = page_info->log;
+        if (delta > 0 && static_cast<uint16_t>(delta) > log->scrollback)
+        {
+            log->scrollback = 0;
+        }
+        else
+        {
+            log->scrollback -= delta;
+        }
+        OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_MOVE_ITEM, log->scrollback);
+        return;
+    }
+    if (page_info != nullptr && page_info->stream != nullptr)
+    {
+        // Streamed pages scroll the document, the end is clamped when the window is read
+        MENU::structs::streamDocument *document = page_info->stream;
+        if (delta < 0 && static_cast<uint32_t>(-delta) > document->top_line)
+        {
+            document->top_line = 0;
+        }
+        else
+        {
+            document->top_line += delta;
+        }
+        OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_MOVE_ITEM, document->top_line);
+        return;
+    }
+    if (page_info == nullptr || page_info->num_lines == 0)
+    {
+        return;
+    }
+    int line = (page_info->page_line + delta) % page_info->num_lines;
+    if (line < 0)
+    {
+        line += page_info->num_lines;
+    }
+    page_info->page_line = line;
+    OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_MOVE_ITEM, page_info->page_line);
+}
+
+/// @brief Post an input event, safe to call from an interrupt.
+/// @param event Input event.
+/// @return True if the event was queued, false if the queue is full.
+bool OLED_MENU_ISR_ATTR OledMenu::postInput(MENU::structs::INPUT_EVENT event)
+{
+    // Single producer: only the producer writes input_head
+    uint8_t head = __atomic_load_n(&input_head, __ATOMIC_RELAXED);
+    uint8_t next = (head + 1) & (OLED_MENU_INPUT_QUEUE_SIZE - 1);
+    if (next == __atomic_load_n(&input_tail, __ATOMIC_ACQUIRE))
+    {
+        inputs_dropped++;
+        return false;
+    }
+    input_queue[head] = event;
+    __atomic_store_n(&input_head, next, __ATOMIC_RELEASE);
+    return true;
+}
+
+/// @brief Apply the queued input events, coalescing consecutive moves.
+/// @return Number of events processed.
+uint8_t OledMenu::processInputs()
+{
+    // Single consumer: only the consumer writes input_tail
+    OLED_MENU_TRACE_BEGIN(inputs);
+    uint8_t tail = __atomic_load_n(&input_tail, __ATOMIC_RELAXED);
+    uint8_t head = __atomic_load_n(&input_head, __ATOMIC_ACQUIRE);
+    uint8_t processed = 0;
+    int page_delta = 0;
+    int item_delta = 0;
+
+    while (tail != head)
+    {
+        MENU::structs::INPUT_EVENT event = static_cast<MENU::structs::INPUT_EVENT>(input_queue[tail]);
+        tail = (tail + 1) & (OLED_MENU_INPUT_QUEUE_SIZE - 1);
+        processed++;
+
+        // Moves of the same kind add up, a move of the other kind applies the pending ones first
+        switch (event)
+        {
+        case MENU::structs::INPUT_EVENT::NEXT_PAGE:
+        case MENU::structs::INPUT_EVENT::PREVIOUS_PAGE:
+            if (item_delta != 0)
+            {
+                applyInputMoves(page_delta, item_delta);
+            }
+            page_delta += (event == MENU::structs::INPUT_EVENT::NEXT_PAGE) ? 1 : -1;
+            break;
+        case MENU::structs::INPUT_EVENT::ITEM_DOWN:
+        case MENU::structs::INPUT_EVENT::ITEM_UP:
+            if (page_delta != 0)
+            {
+                applyInputMoves(page_delta, item_delta);
+            }
+            item_delta += (event == MENU::structs::INPUT_EVENT::ITEM_DOWN) ? 1 : -1;
+            break;
+        default:
+            // Enter and exit apply to the page reached by the moves before them
+            applyInputMoves(page_delta, item_delta);
+            if (event == MENU::structs::INPUT_EVENT::ENTER)
+            {
+                enterCurrentPage();
+            }
+            else if (event == MENU::structs::INPUT_EVENT::EXIT)
+            {
+                exitCurrentPage();
+            }
+            break;
+        }
+    }
+    applyInputMoves(page_delta, item_delta);
+    __atomic_store_n(&input_tail, tail, __ATOMIC_RELEASE);
+#if defined(OLED_MENU_ENABLE_TRACE)
+    if (processed > 0)
+    {
+        OLED_MENU_TRACE_END(inputs, MENU::structs::TRACE_INPUTS, processed);
+    }
+#endif
+    return processed;
+}
+
+/// @brief Apply and reset coalesced page and item moves
+/// @param page_delta Accumulated page moves
+/// @param item_delta Accumulated item moves
+void OledMenu::applyInputMoves(int &page_delta, int &item_delta)
+{
+    if (item_delta != 0)
+    {
+        moveMenuItemBy(item_delta);
+        item_delta = 0;
+    }
+    if (page_delta != 0)
+    {
+        movePageBy(page_delta);
+        page_delta = 0;
+    }
+}
+
+/// @brief Dim, switch off or wake the display depending on the time since the last activity
+/// @return True if the display is asleep and the frame must not be rendered
+bool OledMenu::applyIdlePolicy()
+{
+    unsigned long now = millis();
+    if (idle_activity || error_sequence != power_error_sequence)
+    {
+        idle_activity = false;
+        power_error_sequence = error_sequence;
+        last_activity = now;
+        if (power_state != MENU::structs::AWAKE)
+        {
+            setPowerState(MENU::structs::AWAKE);
+        }
+        return false;
+    }
+    if (power_state == MENU::structs::ASLEEP)
+    {
+        return true;
+    }
+
+    // A frame still being sent by service() is finished before the display is switched off
+    uint32_t idle = now - last_activity;
+    if (idle_sleep_ms > 0 && idle >= idle_sleep_ms && flush_pending_rows == 0)
+    {
+        setPowerState(MENU::structs::ASLEEP);
+        return true;
+    }
+    if (power_state == MENU::structs::AWAKE && idle_dim_ms > 0 && idle >= idle_dim_ms)
+    {
+        setPowerState(MENU::structs::DIMMED);
+    }
+    return false;
+}
+
+/// @brief Switch the display to a power state
+/// @param state New power state
+void OledMenu::setPowerState(MENU::structs::POWER_STATE state)
+{
+    if (state == MENU::structs::ASLEEP)
+    {
+        display_hal.setPowerSave(1);
+    }
+    else
+    {
+        // The contrast is set before the display is switched on, so it never lights up at the old level. While
+        // awake it is only written to leave the dim level, or if the sketch gave an awake level.
+        if (state == MENU::structs::DIMMED)
+        {
+            display_hal.setContrast(dim_contrast);
+            contrast_lowered = true;
+        }
+        else if (awake_contrast >= 0)
+        {
+            display_hal.setContrast(static_cast<uint8_t>(awake_contrast));
+            contrast_lowered = false;
+        }
+        else if (contrast_lowered)
+        {
+            display_hal.setContrast(OLED_MENU_DEFAULT_CONTRAST);
+            contrast_lowered = false;
+        }
+        if (power_state == MENU::structs::ASLEEP)
+        {
+            display_hal.setPowerSave(0);
+        }
+    }
+    power_state = state;
+    OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_POWER, state);
+}
+
+/// @brief Get the time until the idle policy next changes the power state
+/// @param now Current millis()
+/// @return Milliseconds until the next power state change, OLED_MENU_NO_DEADLINE if none
+uint32_t OledMenu::getIdleStepRemaining(unsigned long now)
+{
+    uint32_t step = idle_sleep_ms;
+    if (power_state == MENU::structs::AWAKE && idle_dim_ms > 0 && (idle_sleep_ms == 0 || idle_dim_ms < idle_sleep_ms))
+    {
+        step = idle_dim_ms;
+    }
+    if (step == 0)
+    {
+        return OLED_MENU_NO_DEADLINE;
+    }
+    uint32_t idle = now - last_activity;
+    return idle >= step ? 0 : step - idle;
+}
+
+/// @brief Get the number of lines of the displayed text that were not shown because the text has more than
+///        OLED_MENU_MAX_LINES lines, or wrapped rows with word wrap enabled.
+/// @return Number of lines missing at the end of the displayed text.
+uint16_t OledMenu::getLinesDropped()
+{
+    return line_index.lines_dropped;
+}
+
+/// @brief Get the number of lines of the displayed text that are longer than OLED_MENU_MAX_LINE_CHARS
+///        characters, or 255 characters with word wrap enabled, and were shown cut.
+/// @return Number of cut lines.
+uint16_t OledMenu::getLinesCut()
+{
+    return line_index.lines_cut;
+}
+
+/// @brief Get the number of input events dropped because the queue was full.
+/// @return Number of dropped input events.
+uint16_t OledMenu::getInputsDropped()
+{
+    return inputs_dropped;
+}
+
+/// @brief Dim and switch off the display when there is no activity.
+/// @param dim_after_ms Idle time before the contrast is lowered, 0 to never dim.
+/// @param sleep_after_ms Idle time before the display is switched off with setPowerSave(1), 0 to never sleep.
+/// @param dim_level Contrast while dimmed.
+/// @param awake_level Contrast while awake, OLED_MENU_CONTRAST_UNCHANGED to keep the contrast the sketch set.
+/// @return True if the idle policy is active, false otherwise.
+bool OledMenu::setIdlePolicy(uint32_t dim_after_ms, uint32_t sleep_after_ms, uint8_t dim_level, int16_t awake_level)
+{
+    dim_contrast = dim_level;
+    awake_contrast = awake_level;
+    idle_dim_ms = dim_after_ms;
+    idle_sleep_ms = sleep_after_ms;
+    last_activity = millis();
+    power_error_sequence = error_sequence;
+    idle_activity = false;
+    if (power_state != MENU::structs::AWAKE && display_connected)
+    {
+        setPowerState(MENU::structs::AWAKE);
+    }
+    idle_policy = dim_after_ms > 0 || sleep_after_ms > 0;
+    return idle_policy;
+}
+
+/// @brief Count as activity, the display wakes on the next refreshDisplay().
+void OledMenu::wakeDisplay()
+{
+    idle_activity = true;
+}
+
+/// @brief Get the power state of the display.
+/// @return Power state.
+MENU::structs::POWER_STATE OledMenu::getPowerState()
+{
+    return power_state;
+}
+
+/// @brief Clear the display buffer, releasing all text held in the text arena
+void OledMenu::clearDisplayBuffer()
+{
+    if (text_arena.contains(buffer))
+    {
+        buffer = nullptr;
+        bufferSize = 0;
+    }
+    text_arena.release();
+    memset(display_buffer + error_buffer_size + page_buffer_size, '\0', text_arena.size());
+}
+
+/// @brief Allocate transient text memory that is valid until the next refreshDisplay() call.
+/// @param size Number of bytes.
+/// @return Pointer to the memory, nullptr if the text arena is full.
+/// @note setText(const char *) and clearDisplayBuffer() release the memory earlier.
+char *OledMenu::allocateFrameText(uint16_t size)
+{
+    return reinterpret_cast<char *>(text_arena.allocate(size));
+}
+
+/// @brief Clear the page buffer
+void OledMenu::clearPageBuffer()
+{
+    memset(page_buffer_, '\0', page_buffer_size);
+}
+
+/// @brief Acknowledge the oldest queued error
+void OledMenu::acknowledgeError()
+{
+    if (num_error > 0)
+    {
+        error_head = (error_head + 1) % OLED_MENU_ERROR_QUEUE_SIZE;
+        num_error--;
+    }
+    if (num_error == 0)
+    {
+        OledMenu::error_message_display_override = false;
+    }
+}
+
+/// @brief Check if there is an active error
+/// @return True if there is an active error, false otherwise
+bool OledMenu::hasActiveError()
+{
+    return OledMenu::error_message_display_override;
+}
+
+/// @brief Show an error message
+/// @param fmt Format string for the error message, must stay valid until the error is acknowledged
+/// @param ... Additional arguments for the format string
+/// @return Number of occurrences of this error, -1 if the format string is not supported or the error
+///         queue is full
+int OledMenu::showErrorMessage(const char *fmt, ...)
+{
+    static_assert(OLED_MENU_ERROR_TEXT_SIZE >= 1 && OLED_MENU_ERROR_TEXT_SIZE <= 256,
+                  "String argument offsets are stored as uint8_t");
+    MENU::structs::errorRecord record;
+    memset(&record, 0, sizeof(record));
+    record.fmt = fmt;
+    uint16_t text_used = 0;
+
+    // Capture the arguments, formatting happens when the error page is shown
+    va_list args;
+    va_start(args, fmt);
+    const char *p = fmt;
+    while ((p = strchr(p, '%')) != nullptr)
+    {
+        char conversion;
+        uint8_t stars;
+        bool is_long;
+        const char *spec = p;
+        p = scanFormatSpec(p + 1, conversion, stars, is_long);
+        // formatErrorRecord() rebuilds the specification with every '*' replaced by its int value
+        if (p == nullptr || record.argc + stars + 1 > OLED_MENU_ERROR_MAX_ARGS ||
+            (p - spec) + stars * 10 >= OLED_MENU_ERROR_SPEC_SIZE)
+        {
+            va_end(args);
+            return -1;
+        }
+        for (uint8_t i = 0; i < stars; i++)
+        {
+            record.args[record.argc++].i = va_arg(args, int);
+        }
+        switch (conversion)
+        {
+        case '%':
+            break;
+        case 'd':
+        case 'i':
+        case 'c':
+            record.args[record.argc++].i = is_long ? va_arg(args, long) : va_arg(args, int);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            record.args[record.argc++].u = is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+            break;
+        case 's':
+        {
+            // Copy the string, the caller's buffer may be gone when the error is shown
+            const char *text = va_arg(args, const char *);
+            if (text == nullptr)
+            {
+                text = "(null)";
+            }
+            uint16_t offset = text_used < sizeof(record.text) ? text_used : sizeof(record.text) - 1;
+            size_t len = strnlen(text, sizeof(record.text) - 1 - offset);
+            memcpy(record.text + offset, text, len);
+            record.args[record.argc++].text = offset;
+            text_used = offset + len + 1;
+            break;
+        }
+        case 'p':
+            record.args[record.argc++].p = va_arg(args, void *);
+            break;
+        default:
+            record.args[record.argc++].f = va_arg(args, double);
+            break;
+        }
+    }
+    va_end(args);
+
+    error_message_display_override = true;
+
+    // A repeat of a queued error only bumps its counter
+    for (uint8_t i = 0; i < num_error; i++)
+    {
+        MENU::structs::errorRecord &queued = error_records[(error_head + i) % OLED_MENU_ERROR_QUEUE_SIZE];
+        if (queued.fmt == record.fmt && queued.argc == record.argc && memcmp(queued.args, record.args, sizeof(record.args)) == 0 &&
+            memcmp(queued.text, record.text, sizeof(record.text)) == 0)
+        {
+            if (queued.count < 0xFFFF)
+            {
+                queued.count++;
+            }
+            queued.last_time = millis();
+            return queued.count;
+        }
+    }
+
+    if (num_error >= OLED_MENU_ERROR_QUEUE_SIZE)
+    {
+        // Keep the oldest errors, they are usually the cause of the later ones
+        errors_dropped++;
+        return -1;
+    }
+
+    record.count = 1;
+    record.last_time = millis();
+    record.id = ++error_sequence;
+    error_records[(error_head + num_error) % OLED_MENU_ERROR_QUEUE_SIZE] = record;
+    num_error++;
+    return 1;
+}
+
+/// @brief Get the number of errors dropped because the error queue was full.
+/// @return Number of dropped errors.
+uint16_t OledMenu::getErrorsDropped()
+{
+    return errors_dropped;
+}
+
+/// @brief Scan a printf conversion specification
+/// @param spec Pointer to the character after '%'
+/// @param conversion Set to the conversion character
+/// @param stars Set to the number of '*' width and precision arguments
+/// @param is_long Set when the argument is a long
+/// @return Pointer to the character after the conversion, nullptr if the specification is not supported
+const char *OledMenu::scanFormatSpec(const char *spec, char &conversion, uint8_t &stars, bool &is_long)
+{
+    stars = 0;
+    is_long = false;
+    bool sized = false;
+    while (*spec != '\0' && strchr("-+ #0", *spec) != nullptr)
+    {
+        spec++;
+    }
+    for (uint8_t field = 0; field < 2; field++)
+    {
+        // Width, then precision
+        if (field == 1)
+        {
+            if (*spec != '.')
+            {
+                break;
+            }
+            spec++;
+        }
+        if (*spec == '*')
+        {
+            stars++;
+            spec++;
+        }
+        while (*spec >= '0' && *spec <= '9')
+        {
+            spec++;
+        }
+    }
+    while (*spec == 'h')
+    {
+        sized = true;
+        spec++; // Promoted to int
+    }
+    if (*spec == 'l')
+    {
+        is_long = true;
+        sized = true;
+        spec++;
+        if (*spec == 'l')
+        {
+            return nullptr; // long long is not stored
+        }
+    }
+    else if (*spec == 'z' || *spec == 't')
+    {
+        is_long = sizeof(size_t) == sizeof(long);
+        sized = true;
+        spec++;
+    }
+    conversion = *spec;
+    if (conversion == '\0' || strchr("diucxXofFeEgGaAsp%", conversion) == nullptr)
+    {
+        return nullptr;
+    }
+    if (sized && strchr("csp", conversion) != nullptr)
+    {
+        return nullptr; // %lc and %ls take wide characters, which are not stored
+    }
+    return spec + 1;
+}
+
+/// @brief Format an error record, appending the repeat count
+/// @param record Error record to format
+/// @param out Output buffer
+/// @param size Size of the output buffer
+void OledMenu::formatErrorRecord(const MENU::structs::errorRecord &record, char *out, uint16_t size)
+{
+    uint16_t pos = 0;
+    uint8_t arg = 0;
+    const char *p = record.fmt;
+    out[0] = '\0';
+    while (*p != '\0' && pos + 1 < size)
+    {
+        if (*p != '%')
+        {
+            out[pos++] = *p++;
+            continue;
+        }
+
+        char conversion;
+        uint8_t stars;
+        bool is_long;
+        const char *end = scanFormatSpec(p + 1, conversion, stars, is_long);
+
+        // Rebuild the specification with '*' replaced by the captured values, showErrorMessage() checked it fits
+        char spec[OLED_MENU_ERROR_SPEC_SIZE];
+        uint8_t spec_len = 0;
+        for (const char *c = p; c < end; c++)
+        {
+            if (*c == '*')
+            {
+                spec_len += snprintf(spec + spec_len, sizeof(spec) - spec_len, "%d", static_cast<int>(record.args[arg++].i));
+            }
+            else
+            {
+                spec[spec_len++] = *c;
+            }
+        }
+        spec[spec_len] = '\0';
+
+        int written;
+        switch (conversion)
+        {
+        case '%':
+            written = snprintf(out + pos, size - pos, "%%");
+            break;
+        case 'd':
+        case 'i':
+        case 'c':
+            written = is_long ? snprintf(out + pos, size - pos, spec, record.args[arg].i)
+                              : snprintf(out + pos, size - pos, spec, static_cast<int>(record.args[arg].i));
+            arg++;
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            written = is_long ? snprintf(out + pos, size - pos, spec, record.args[arg].u)
+                              : snprintf(out + pos, size - pos, spec, static_cast<unsigned int>(record.args[arg].u));
+            arg++;
+            break;
+        case 's':
+            written = snprintf(out + pos, size - pos, spec, record.text + record.args[arg++].text);
+            break;
+        case 'p':
+            written = snprintf(out + pos, size - pos, spec, record.args[arg++].p);
+            break;
+        default:
+            written = snprintf(out + pos, size - pos, spec, record.args[arg++].f);
+            break;
+        }
+        if (written > 0)
+        {
+            pos = (pos + written < size) ? pos + written : size - 1;
+        }
+        p = end;
+    }
+    out[pos] = '\0';
+
+    if (record.count > 1)
+    {
+        snprintf(out + pos, size - pos, " x%u", record.count);
+    }
+}
+
+/// @brief Check if a page is entered
+/// @return True if a page is entered, false otherwise
+bool OledMenu::isPageEntered()
+{
+    return page_entered;
+}
+
+/// @brief Exit the current page
+void OledMenu::exitCurrentPage()
+{
+    idle_activity = true;
+    page_entered = false;
+    OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_EXIT_PAGE, current_page_displayed);
+}
+
+/// @brief Check if the current page is interactive
+/// @return True if the current page is interactive, false otherwise
+bool OledMenu::isCurrentPageInteractive()
+{
+    MENU::structs::menuPageInfo *current_page = getMenuPageInfo(current_page_displayed);
+    return current_page != nullptr && current_page->interactive;
+}
+
+/// @brief Enter the current page
+/// @return True if the page was entered successfully, false otherwise
+bool OledMenu::enterCurrentPage()
+{
+    idle_activity = true;
+    if (isCurrentPageInteractive())
+    {
+        page_entered = true;
+        OLED_MENU_TRACE_INSTANT(MENU::structs::TRACE_ENTER_PAGE, current_page_displayed);
+        return true;
+    }
+    return false;
+}
+
+/// @brief Get the menu page info for a given page
+/// @param page Index of the page
+/// @return Pointer to the menu page info
+MENU::structs::menuPageInfo *OledMenu::getMenuPageInfo(uint8_t page)
+{
+    return page < num_pages ? &pages[page] : nullptr;
+}
+
+/// @brief Get the error page info for a given page
+/// @param page Index of the page
+/// @return Pointer to the error page info
+MENU::structs::errorPageInfo *OledMenu::getErrorPageInfo(uint8_t page)
+{
+    return page < num_error_pages ? &error_pages[page] : nullptr;
+}
+
+/// @brief Set the text to be displayed and scrolled.
+/// @param txt The text to be displayed.
+/// @note The copy reuses the whole text arena, pointers from allocateFrameText() are no longer valid.
+void OledMenu::setText(const char *txt)
+{
+    size_t len = strlen(txt) + 1;
+    if (len > text_arena.size())
+    {
+        clearDisplayBuffer();
+        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
+        displayText(false);
+        return;
+    }
+    // The previous text is replaced, so the whole arena is reused, frame text included
+    text_arena.release();
+    char *copy = reinterpret_cast<char *>(text_arena.allocate(len));
+    memcpy(copy, txt, len);
+    text_arena.setMark(); // Keep the copy across per-frame resets
+    buffer = copy;
+    bufferSize = len;
+}
+
+/// @brief Set the text to be displayed and scrolled using an external buffer.
+/// @param buf The buffer to hold the text.
+/// @param bufSize The size of the buffer.
+void OledMenu::setText(char *buf, size_t bufSize)
+{
+    if (bufSize > display_buffer_size)
+    {
+        clearDisplayBuffer();
+        snprintf(error_buffer_, error_buffer_size, "Insufficient display_buffer size");
+        displayText(false);
+        return;
+    }
+    buffer = buf;
+    bufferSize = bufSize;
+}
+
+/// @brief Manage the blinking state of the cursor.
+void OledMenu::manageCursorBlink()
+{
+    unsigned long currentTime = millis();
+    if (blinkEnabled && (currentTime - lastBlinkTime >= static_cast<unsigned long>(blinkInterval)))
+    {
+        blinkState = !blinkState;
+        lastBlinkTime = currentTime;
+    }
+}
+
+/// @brief Blink the text at the cursor position.
+void OledMenu::blinkTextAtCursorPosition()
+{
+    displayText(blinkState);
+}
+
+/// @brief Set the number of display lines.
+/// @param num_lines Number of lines to display.
+void OledMenu::setNumberOfDisplayLines(int num_lines)
+{
+    if (num_lines >= minLines && num_lines <= maxLines)
+    {
+        dispLines = num_lines;
+    }
+    else if (num_lines < minLines)
+    {
+        dispLines = minLines;
+    }
+    else if (num_lines > maxLines)
+    {
+        dispLines = maxLines;
+    }
+    selectLineFont();
+}
+
+/// @brief Get the number of display lines.
+/// @return Number of lines to display.
+int OledMenu::getNumberOfDisplayLines()
+{
+    return dispLines;
+}
+
+/// @brief Set the font size based on the number of lines to be displayed, if it is not already active.
+void OledMenu::setFontSizeForLineLimits()
+{
+    const uint8_t *font = getLineFont();
+    if (display_hal.getU8g2()->font != font)
+    {
+        display_hal.setFont(font);
+    }
+}
+
+/// @brief Select the font for the number of lines to be displayed.
+void OledMenu::selectLineFont()
+{
+    uint8_t fontPixelHeight = maxHeight / dispLines;
+    line_font_index = NELEMS(u8g2_font_lookup_table); // Fallback font
+    if (fontPixelHeight >= fontMinPixelHeight && fontPixelHeight <= fontMaxPixelHeight)
+    {
+        // Ensure the lookup table is defined and within bounds
+        uint8_t index = fontPixelHeight - fontMinPixelHeight;
+        if (index < NELEMS(u8g2_font_lookup_table))
+        {
+            line_font_index = index;
+        }
+    }
+}
+
+/// @brief Get the font selected for the number of lines to be displayed.
+/// @return Pointer to the font.
+const uint8_t *OledMenu::getLineFont()
+{
+    if (line_font_index < NELEMS(u8g2_font_lookup_table))
+    {
+        return u8g2_font_lookup_table[line_font_index];
+    }
+    return u8g2_font_helvB08_tf; // Default font as fallback
+}
+
+/// @brief Get the metrics of the font selected for the number of lines to be displayed.
+/// @return Cached font metrics.
+const MENU::structs::fontMetrics &OledMenu::getLineFontMetrics()
+{
+    if (!font_metrics_valid)
+    {
+        buildFontMetrics();
+    }
+    return font_metrics[line_font_index];
+}
+
+/// @brief Measure the metrics of all lookup table fonts once.
+void OledMenu::buildFontMetrics()
+{
+    const uint8_t *previous_font = display_hal.getU8g2()->font;
+    for (uint8_t i = 0; i < NELEMS(font_metrics); i++)
+    {
+        display_hal.setFont(i < NELEMS(u8g2_font_lookup_table) ? u8g2_font_lookup_table[i] : u8g2_font_helvB08_tf);
+        font_metrics[i].height = display_hal.getMaxCharHeight();
+        font_metrics[i].width = display_hal.getMaxCharWidth();
+        font_metrics[i].ascent = display_hal.getAscent();
+        font_metrics[i].descent = display_hal.getDescent();
+        font_metrics[i].line_spacing = font_metrics[i].height;
+    }
+    if (previous_font != nullptr)
+    {
+        display_hal.setFont(previous_font);
+    }
+    font_metrics_valid = true;
+}
+
+#if defined(OLED_MENU_ENABLE_STATS)
+/// @brief Get the render pipeline statistics since the last reset.
+/// @return Timing of every stage, frames per second and frame counts.
+MENU::structs::renderStats OledMenu::getRenderStats()
+{
+    MENU::structs::renderStats stats;
+    for (uint8_t i = 0; i < MENU::structs::STAGE_COUNT; i++)
+    {
+        const MENU::structs::stageAccumulator &timing = stage_timing[i];
+        MENU::structs::stageStats &stage = stats.stages[i];
+        stage.count = timing.count;
+        if (timing.count == 0)
+        {
+            continue;
+        }
+        stage.min_us = timing.min_us;
+        stage.max_us = timing.max_us;
+        stage.avg_us = timing.total_us / timing.count;
+
+        // Walk the histogram up to 99% of the runs, it may have been halved so count its entries
+        uint32_t entries = 0;
+        for (uint8_t b = 0; b < OLED_MENU_STATS_BUCKETS; b++)
+        {
+            entries += timing.histogram[b];
+        }
+        uint32_t target = entries - entries / 100;
+        uint32_t seen = 0;
+        stage.p99_us = timing.max_us;
+        for (uint8_t b = 0; b < OLED_MENU_STATS_BUCKETS; b++)
+        {
+            seen += timing.histogram[b];
+            if (seen >= target)
+            {
+                uint32_t limit = stageBucketLimit(b);
+                stage.p99_us = limit < timing.max_us ? limit : timing.max_us;
+                break;
+            }
+        }
+    }
+
+    stats.frames_drawn = frames_drawn - stats_frames_drawn;
+    stats.frames_skipped = frames_skipped - stats_frames_skipped;
+    unsigned long elapsed = millis() - stats_start;
+    stats.fps = elapsed > 0 ? stats.frames_drawn * 1000.0f / elapsed : 0;
+    return stats;
+}
+
+/// @brief Print the render pipeline statistics on one line, min/avg/max/p99 in microseconds per stage.
+/// @param out Print object to write to.
+void OledMenu::printRenderStats(Print &out)
+{
+    static const char *const stage_names[MENU::structs::STAGE_COUNT] = {"callback", "layout", "draw", "flush"};
+    MENU::structs::renderStats stats = getRenderStats();
+    for (uint8_t i = 0; i < MENU::structs::STAGE_COUNT; i++)
+    {
+        out.print(stage_names[i]);
+        out.print('=');
+        out.print(static_cast<unsigned long>(stats.stages[i].min_us));
+        out.print('/');
+        out.print(static_cast<unsigned long>(stats.stages[i].avg_us));
+        out.print('/');
+        out.print(static_cast<unsigned long>(stats.stages[i].max_us));
+        out.print('/');
+        out.print(static_cast<unsigned long>(stats.stages[i].p99_us));
+        out.print(' ');
+    }
+    out.print(F("fps="));
+    out.print(stats.fps, 1);
+    out.print(F(" drawn="));
+    out.print(static_cast<unsigned long>(stats.frames_drawn));
+    out.print(F(" skipped="));
+    out.println(static_cast<unsigned long>(stats.frames_skipped));
+}
+
+/// @brief Reset the render pipeline statistics.
+void OledMenu::resetRenderStats()
+{
+    for (uint8_t i = 0; i < MENU::structs::STAGE_COUNT; i++)
+    {
+        stage_timing[i] = MENU::structs::stageAccumulator();
+    }
+    stats_start = millis();
+    stats_frames_drawn = frames_drawn;
+    stats_frames_skipped = frames_skipped;
+}
+
+/// @brief Record the duration of a render stage
+/// @param stage Render stage
+/// @param us Duration in microseconds
+void OledMenu::recordStageTime(MENU::structs::RENDER_STAGE stage, uint32_t us)
+{
+    MENU::structs::stageAccumulator &timing = stage_timing[stage];
+    if (timing.count == 0 || us < timing.min_us)
+    {
+        timing.min_us = us;
+    }
+    if (us > timing.max_us)
+    {
+        timing.max_us = us;
+    }
+    timing.count++;
+    timing.total_us += us;
+
+    // Halve the histogram before a bucket overflows, the shape of the distribution is kept
+    uint8_t bucket = stageBucket(us);
+    if (timing.histogram[bucket] == 0xFFFF)
+    {
+        for (uint8_t b = 0; b < OLED_MENU_STATS_BUCKETS; b++)
+        {
+            timing.histogram[b] /= 2;
+        }
+    }
+    timing.histogram[bucket]++;
+}
+
+/// @brief Get the histogram bucket of a duration
+/// @param us Duration in microseconds
+/// @return Index of the bucket
+uint8_t OledMenu::stageBucket(uint32_t us)
+{
+    if (us == 0)
+    {
+        return 0;
+    }
+    // Two buckets per power of two, split on the bit below the highest one
+    uint8_t msb = 31;
+    while ((us & (1UL << msb)) == 0)
+    {
+        msb--;
+    }
+    uint8_t half = msb > 0 ? (us >> (msb - 1)) & 1 : 0;
+    uint16_t bucket = 1 + msb * 2 + half;
+    return bucket < OLED_MENU_STATS_BUCKETS ? bucket : OLED_MENU_STATS_BUCKETS - 1;
+}
+
+/// @brief Get the longest duration of a histogram bucket
+/// @param bucket Index of the bucket
+/// @return Duration in microseconds
+uint32_t OledMenu::stageBucketLimit(uint8_t bucket)
+{
+    if (bucket == 0)
+    {
+        return 0;
+    }
+    if (bucket == OLED_MENU_STATS_BUCKETS - 1)
+    {
+        return 0xFFFFFFFFUL; // Everything longer ends up in the last bucket
+    }
+    uint8_t msb = (bucket - 1) / 2;
+    uint8_t half = (bucket - 1) % 2;
+    if (msb == 0)
+    {
+        return 1;
+    }
+    uint32_t step = 1UL << (msb - 1);
+    return (1UL << msb) + (half + 1) * step - 1;
+}
+#endif
+
+#if defined(OLED_MENU_ENABLE_TRACE)
+/// @brief Write the trace ring as Chrome trace_event JSON, load it in chrome://tracing or Perfetto.
+/// @param out Print object to write to, e.g. Serial or a file on host builds.
+void OledMenu::writeChromeTrace(Print &out)
+{
+    static const char *const event_names[MENU::structs::TRACE_EVENT_COUNT] = {
+        "refreshDisplay", "renderMenuPageText", "renderErrorPageText", "callback", "displayText", "flushDisplay",
+        "service", "processInputs", "movePageBy", "moveMenuItemBy", "enterCurrentPage", "exitCurrentPage", "power"};
+    static const char *const arg_names[MENU::structs::TRACE_EVENT_COUNT] = {
+        "page", "page", "errors", "page", "drawn", "rows", "rows", "events", "page", "line", "page", "page", "state"};
+
+    uint16_t count = trace_recorded < OLED_MENU_TRACE_SIZE ? trace_recorded : OLED_MENU_TRACE_SIZE;
+    uint16_t first = (trace_head + OLED_MENU_TRACE_SIZE - count) % OLED_MENU_TRACE_SIZE;
+
+    // Events are stored when they end, so a span follows the spans nested in it. Timestamps are made
+    // relative to the earliest start, measured back from the newest end so a micros() wrap is harmless.
+    uint32_t base = 0;
+    if (count > 0)
+    {
+        const MENU::structs::traceRecord &newest = trace_ring[(first + count - 1) % OLED_MENU_TRACE_SIZE];
+        uint32_t end = newest.start_us + newest.duration_us;
+        uint32_t oldest_age = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint32_t age = end - trace_ring[(first + i) % OLED_MENU_TRACE_SIZE].start_us;
+            if (age > oldest_age)
+            {
+                oldest_age = age;
+            }
+        }
+        base = end - oldest_age;
+    }
+
+    out.print(F("{\"traceEvents\":["));
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const MENU::structs::traceRecord &record = trace_ring[(first + i) % OLED_MENU_TRACE_SIZE];
+        if (i > 0)
+        {
+            out.print(',');
+        }
+        out.print(F("\n{\"name\":\""));
+        out.print(event_names[record.event]);
+        if (record.instant)
+        {
+            out.print(F("\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"));
+            out.print(static_cast<unsigned long>(record.start_us - base));
+        }
+        else
+        {
+            out.print(F("\",\"ph\":\"X\",\"ts\":"));
+            out.print(static_cast<unsigned long>(record.start_us - base));
+            out.print(F(",\"dur\":"));
+            out.print(static_cast<unsigned long>(record.duration_us));
+        }
+        out.print(F(",\"pid\":1,\"tid\":1,\"args\":{\""));
+        out.print(arg_names[record.event]);
+        out.print(F("\":"));
+        out.print(record.arg);
+        out.print(F("}}"));
+    }
+    out.print(F("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"overwritten\":"));
+    out.print(static_cast<unsigned long>(getTraceOverwritten()));
+    out.println(F("}}"));
+}
+
+/// @brief Discard the recorded trace events.
+void OledMenu::clearTrace()
+{
+    trace_head = 0;
+    trace_recorded = 0;
+}
+
+/// @brief Get the number of trace events overwritten since the last clear.
+/// @return Number of events lost because the ring was full.
+uint32_t OledMenu::getTraceOverwritten()
+{
+    return trace_recorded > OLED_MENU_TRACE_SIZE ? trace_recorded - OLED_MENU_TRACE_SIZE : 0;
+}
+
+/// @brief Record a trace event, overwriting the oldest when the ring is full
+/// @param event Trace event
+/// @param start_us micros() at the start of the event
+/// @param duration_us Duration in microseconds
+/// @param arg Event argument
+/// @param instant Whether the event is a point in time rather than a span
+void OledMenu::recordTrace(MENU::structs::TRACE_EVENT event, uint32_t start_us, uint32_t duration_us, uint16_t arg, bool instant)
+{
+    MENU::structs::traceRecord &record = trace_ring[trace_head];
+    record.start_us = start_us;
+    record.duration_us = duration_us;
+    record.arg = arg;
+    record.event = event;
+    record.instant = instant;
+    trace_head = (trace_head + 1) % OLED_MENU_TRACE_SIZE;
+    trace_recorded++;
+}
+#endif
+
+/// @brief Get the RAM used by this menu configuration.
+/// @return RAM footprint.
+MENU::structs::memoryFootprint OledMenu::getMemoryFootprint()
+{
+    MENU::structs::memoryFootprint footprint;
+    footprint.object = sizeof(*this);
+    footprint.page_tables = sizeof(MENU::structs::menuPageInfo) * max_pages + sizeof(MENU::structs::errorPageInfo) * max_error_pages;
+    footprint.display_buffer = display_buffer_size;
+    footprint.text_arena_high_water = text_arena.highWater();
+    footprint.frame_buffer = display_hal.getBufferTileHeight() * display_hal.getBufferTileWidth() * 8;
+    footprint.tile_shadow = tile_shadow_buffer != nullptr ? tile_shadow_size : 0;
+    footprint.word_wrap = wrap_cache != nullptr ? sizeof(*wrap_cache) : 0;
+    footprint.mirror = mirror_shadow != nullptr ? mirror_shadow_size : 0;
+    footprint.total = footprint.object + footprint.page_tables + footprint.display_buffer + footprint.frame_buffer + footprint.tile_shadow +
+                      footprint.word_wrap + footprint.mirror;
+    return footprint;
+}
+
+/// @brief Print the RAM used by this menu configuration on one line.
+/// @param out Print object to write to.
+void OledMenu::printMemoryFootprint(Print &out)
+{
+    MENU::structs::memoryFootprint footprint = getMemoryFootprint();
+    out.print(F("pages="));
+    out.print(num_pages);
+    out.print('/');
+    out.print(max_pages);
+    out.print(F(" error_pages="));
+    out.print(num_error_pages);
+    out.print('/');
+    out.print(max_error_pages);
+    out.print(F(" object="));
+    out.print(static_cast<unsigned long>(footprint.object));
+    out.print(F(" page_tables="));
+    out.print(static_cast<unsigned long>(footprint.page_tables));
+    out.print(F(" display_buffer="));
+    out.print(static_cast<unsigned long>(footprint.display_buffer));
+    out.print(F(" text_arena_high_water="));
+    out.print(static_cast<unsigned long>(footprint.text_arena_high_water));
+    out.print(F(" frame_buffer="));
+    out.print(static_cast<unsigned long>(footprint.frame_buffer));
+    out.print(F(" tile_shadow="));
+    out.print(static_cast<unsigned long>(footprint.tile_shadow));
+    out.print(F(" word_wrap="));
+    out.print(static_cast<unsigned long>(footprint.word_wrap));
+    out.print(F(" mirror="));
+    out.print(static_cast<unsigned long>(footprint.mirror));
+    out.print(F(" total="));
+    out.println(static_cast<unsigned long>(footprint.total));
+}
+
+/// @brief Get the current X position of the cursor.
+/// @return The X position of the cursor.
+int OledMenu::getCursorXPosition()
+{
+    return page_info->cursorX;
+}
+
+/// @brief Get the current Y position of the cursor.
+/// @return The Y position of the cursor.
+int OledMenu::getCursorYPosition()
+{
+    return page_info->cursorY;
+}
+
+/// @brief Get the width of a character in the current font.
+/// @return The width of a character.
+int OledMenu::getFontCharacterWidth()
+{
+    return getLineFontMetrics().width;
+}
+
+/// @brief Set the display anchor position.
+/// @param x X position of the anchor.
+/// @param y Y position of the anchor.
+void OledMenu::setDisplayAnchor(int x, int y)
+{
+    page_info->anchorX = x;
+    page_info->anchorY = y + getLineFontMetrics().height;
+}
+
+/// @brief Get the anchor position.
+/// @param x X position of the anchor.
+/// @param y Y position of the anchor.
+void OledMenu::getDisplayAnchor(int &x, int &y)
+{
+    x = page_info->anchorX;
+    y = page_info->anchorY;
+}
+
+/// @brief Set the cursor position.
+/// @param x X position of the cursor.
+/// @param y Y position of the cursor.
+void OledMenu::setCursorPosition(int x, int y)
+{
+    page_info->cursorX = x;
+    page_info->cursorY = y;
+}
+
+/// @brief Get cursor position.
+/// @param x X position of the cursor.
+/// @param y Y position of the cursor.
+void OledMenu::getCursorPosition(int &x, int &y)
+{
+    x = page_info->cursorX;
+    y = page_info->cursorY;
+}
+
+void OledMenu::scroll(int x, int y)
+{
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    int charWidth = metrics.width;
+    int charHeight = metrics.height;
+
+    // Calculate text width and height based on max_chars_on_line and num_lines, or the measured width of wrapped text
+    int textWidth = charWidth * page_info->max_chars_on_line;
+    if (line_index.source == page_info->buffer && line_index.max_line_width > 0)
+    {
+        textWidth = line_index.max_line_width;
+    }
+    int textHeight = charHeight * page_info->num_lines;
+
+    // Calculate new cursor position
+    int newCursorX = page_info->cursorX + x;
+    int newCursorY = page_info->cursorY + y;
+
+    // Ensure cursor stays within the bounds of the display
+    if (newCursorX < 0)
+    {
+        newCursorX = 0;
+    }
+    else if (newCursorX > maxWidth - charWidth)
+    {
+        newCursorX = maxWidth - charWidth;
+    }
+
+    if (newCursorY < 0)
+    {
+        newCursorY = 0;
+    }
+    else if (newCursorY > maxHeight - charHeight)
+    {
+        newCursorY = maxHeight - charHeight;
+    }
+
+    // Update cursor position
+    page_info->cursorX = newCursorX;
+    page_info->cursorY = newCursorY;
+
+    // Calculate offsets if cursor is at the edge
+    int offsetX = page_info->anchorX;
+    int offsetY = page_info->anchorY;
+
+    if (newCursorX == 0 || newCursorX == maxWidth - charWidth)
+    {
+        offsetX = (maxWidth - textWidth) / 2 + x;
+    }
+
+    if (newCursorY == 0 || newCursorY == maxHeight - charHeight)
+    {
+        offsetY = (maxHeight - textHeight) / 2 + y;
+    }
+
+    // Store offsets for later use in rendering
+    page_info->anchorX = offsetX;
+    page_info->anchorY = offsetY;
+}
+
+/// @brief Render text for the current menu page, running its callback when due
+void OledMenu::renderMenuPageText()
+{
+    page_info = getMenuPageInfo(current_page_displayed);
+    if (page_info == nullptr)
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+    buffer = page_info->buffer;
+    bufferSize = page_info->needs_buffer_size;
+    bool page_changed = page_info != last_rendered_page;
+    uint32_t changed_fields = 0;
+    uint8_t log_lines_moved = 0;
+    if (page_changed || isPageRefreshDue(page_info, now))
+    {
+        OLED_MENU_TRACE_BEGIN(callback);
+        OLED_MENU_STAGE_BEGIN(callback);
+        if (page_info->fields != nullptr)
+        {
+            // The buffer may be the shared page buffer, written by the pages shown since, so the static text is
+            // laid out again and all fields are formatted
+            if (page_changed)
+            {
+                expandTemplateLayout(page_info);
+            }
+            changed_fields = updateTemplateFields(page_info, page_changed);
+        }
+        else if (page_info->stream != nullptr)
+        {
+            // A requested refresh may follow an append, so the end of the document is looked up again
+            if (page_info->refresh_requested)
+            {
+                page_info->stream->end_known = false;
+            }
+            fillStreamWindow(page_info);
+            bufferSize = page_info->needs_buffer_size;
+        }
+        else if (page_info->log != nullptr)
+        {
+            log_lines_moved = buildLogWindow(page_info);
+            bufferSize = page_info->needs_buffer_size;
+        }
+        else if (page_info->callback)
+        {
+            page_info->callback(page_info);
+            bufferSize = page_info->needs_buffer_size;
+        }
+        OLED_MENU_STAGE_END(callback, MENU::structs::RENDER_STAGE::CALLBACK);
+        OLED_MENU_TRACE_END(callback, MENU::structs::TRACE_CALLBACK, current_page_displayed);
+        markPageRefreshed(page_info, now);
+    }
+    else if (page_info->refresh_policy != MENU::structs::REFRESH_POLICY::EVERY_CALL &&
+             frame_hash_valid && renderStateHash(false) == last_state_hash)
+    {
+        // Callback not due and nothing moved, the frame on the display is current
+        frames_skipped++;
+        return;
+    }
+
+    if (!page_changed && page_info->fields != nullptr && canRedrawTemplateFields())
+    {
+        // The static text is already on the display, only the changed fields are drawn
+        if (changed_fields == 0)
+        {
+            frames_skipped++;
+            return;
+        }
+        redrawTemplateFields(changed_fields);
+        return;
+    }
+    if (!page_changed && canScrollLogTail(log_lines_moved))
+    {
+        // Following the tail, the lines still shown only move up
+        scrollLogTail(log_lines_moved);
+        return;
+    }
+    last_rendered_page = page_info;
+    displayText(false);
+}
+
+/// @brief Expand the layout of a template page into its buffer, reserving the width of every field
+/// @param page Template page
+/// @return True if the layout fits the buffer and has one "{}" per field, false otherwise
+bool OledMenu::expandTemplateLayout(MENU::structs::menuPageInfo *page)
+{
+    MENU::structs::templateField *fields = page->fields;
+    char *page_buffer = page->buffer;
+    uint16_t pos = 0;
+    uint8_t field = 0;
+    uint8_t line = 0;
+    for (const char *p = page->layout; *p != '\0'; p++)
+    {
+        if (p[0] == '{' && p[1] == '}')
+        {
+            if (field >= page->num_fields || fields[field].width == 0 || fields[field].width > OLED_MENU_MAX_FIELD_WIDTH ||
+                pos + fields[field].width >= page->target_buffer_size)
+            {
+                return false;
+            }
+            fields[field].offset = pos;
+            fields[field].line = line;
+            memset(page_buffer + pos, ' ', fields[field].width);
+            pos += fields[field].width;
+            field++;
+            p++;
+            continue;
+        }
+        if (pos + 1 >= page->target_buffer_size)
+        {
+            return false;
+        }
+        if (*p == '\n')
+        {
+            line++;
+        }
+        page_buffer[pos++] = *p;
+    }
+    if (field != page->num_fields)
+    {
+        return false;
+    }
+    page_buffer[pos] = '\0';
+    page->needs_buffer_size = pos + 1;
+    return true;
+}
+
+/// @brief Format the fields of a template page whose value changed into the page buffer
+/// @param page Template page
+/// @param force True to format all fields
+/// @return Bit mask of the fields that were formatted
+uint32_t OledMenu::updateTemplateFields(MENU::structs::menuPageInfo *page, bool force)
+{
+    uint32_t changed = 0;
+    for (uint8_t i = 0; i < page->num_fields; i++)
+    {
+        MENU::structs::templateField &field = page->fields[i];
+        uint32_t value = readTemplateField(field);
+        if (force || value != field.last_value)
+        {
+            field.last_value = value;
+            formatTemplateField(field, page->buffer);
+            changed |= 1UL << i;
+        }
+    }
+    return changed;
+}
+
+/// @brief Format a template field into its slot of a page buffer
+/// @param field Field to format
+/// @param page_buffer Page buffer
+void OledMenu::formatTemplateField(const MENU::structs::templateField &field, char *page_buffer)
+{
+    // Widths are checked by addTemplatePage(), bounding them here keeps every format inside text
+    static_assert(OLED_MENU_MAX_FIELD_WIDTH <= 63, "OLED_MENU_MAX_FIELD_WIDTH must leave room in the format buffer");
+    char text[64];
+    uint8_t width = field.width > OLED_MENU_MAX_FIELD_WIDTH ? OLED_MENU_MAX_FIELD_WIDTH : field.width;
+    bool numeric = true;
+    switch (field.type)
+    {
+    case MENU::structs::FIELD_TYPE::INT:
+        snprintf(text, sizeof(text), "%*ld", width, static_cast<long>(*static_cast<const volatile int32_t *>(field.value)));
+        break;
+    case MENU::structs::FIELD_TYPE::FLOAT:
+        // Up to 39 integer digits, sign, point and 9 decimals fit even at the widest field
+        dtostrf(*static_cast<const volatile float *>(field.value), width, field.precision > 9 ? 9 : field.precision, text);
+        break;
+    case MENU::structs::FIELD_TYPE::IP:
+    {
+        uint32_t address = *static_cast<const volatile uint32_t *>(field.value);
+        const uint8_t *octets = reinterpret_cast<const uint8_t *>(&address);
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        numeric = false;
+        break;
+    }
+    default:
+        snprintf(text, sizeof(text), "%.*s", width, static_cast<const char *>(const_cast<const void *>(field.value)));
+        numeric = false;
+        break;
+    }
+
+    // Keep the layout fixed: pad short values, mark numbers that do not fit, cut text
+    size_t len = strlen(text);
+    char *slot = page_buffer + field.offset;
+    if (len > field.width && numeric)
+    {
+        memset(slot, '#', field.width);
+        return;
+    }
+    if (len > field.width)
+    {
+        len = field.width;
+    }
+    memcpy(slot, text, len);
+    memset(slot + len, ' ', field.width - len);
+}
+
+/// @brief Get the raw value of a template field, or a hash of it for STRING fields
+/// @param field Field to read
+/// @return Value used to detect changes
+uint32_t OledMenu::readTemplateField(const MENU::structs::templateField &field)
+{
+    switch (field.type)
+    {
+    case MENU::structs::FIELD_TYPE::INT:
+        return static_cast<uint32_t>(*static_cast<const volatile int32_t *>(field.value));
+    case MENU::structs::FIELD_TYPE::FLOAT:
+    {
+        float value = *static_cast<const volatile float *>(field.value);
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+    case MENU::structs::FIELD_TYPE::IP:
+        return *static_cast<const volatile uint32_t *>(field.value);
+    default:
+    {
+        const char *value = static_cast<const char *>(const_cast<const void *>(field.value));
+        return hashBytes(2166136261UL, value, strnlen(value, field.width));
+    }
+    }
+}
+
+/// @brief Check if the frame on the display is the current template page, so fields can be redrawn in place
+/// @return True if the changed fields can be drawn over the last frame
+bool OledMenu::canRedrawTemplateFields()
+{
+    // A page buffer holds no previous frame, a highlight box would have to be redrawn as well,
+    // and wrapped rows move when a field changes width
+    return !isPageBufferMode() && !highlightEnabled && wrap_cache == nullptr && frame_hash_valid && line_index.source == buffer &&
+           renderStateHash(false) == last_state_hash;
+}
+
+/// @brief Draw changed template fields over the last frame and flush it
+/// @param changed Bit mask of the changed fields
+void OledMenu::redrawTemplateFields(uint32_t changed)
+{
+    OLED_MENU_STAGE_BEGIN(draw);
+    setFontSizeForLineLimits();
+    display_hal.setFontMode(1);
+
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    int top_offset = metrics.ascent;
+    int box_height = metrics.ascent - metrics.descent;
+    int last_line = -1;
+
+    for (uint8_t i = 0; i < page_info->num_fields; i++)
+    {
+        const MENU::structs::templateField &field = page_info->fields[i];
+        // Fields are in layout order, the first changed field of a line redraws the rest of it
+        if ((changed & (1UL << i)) == 0 || field.line == last_line || field.line >= line_index.num_lines)
+        {
+            continue;
+        }
+        last_line = field.line;
+
+        // With a proportional font the text after a field moves with it, so the box ends at the display edge
+        uint16_t line_start = line_index.start[field.line];
+        uint16_t line_end = line_start + line_index.length[field.line];
+        char span[OLED_MENU_MAX_LINE_CHARS + 1];
+        uint16_t prefix_len = field.offset - line_start;
+        if (prefix_len > OLED_MENU_MAX_LINE_CHARS)
+        {
+            prefix_len = OLED_MENU_MAX_LINE_CHARS;
+        }
+        memcpy(span, buffer + line_start, prefix_len);
+        span[prefix_len] = '\0';
+        int x = page_info->anchorX + display_hal.getStrWidth(span);
+        int y = page_info->anchorY + field.line * metrics.line_spacing;
+        if (x >= static_cast<int>(maxWidth))
+        {
+            continue;
+        }
+
+        uint16_t tail_len = line_end - field.offset;
+        if (tail_len > OLED_MENU_MAX_LINE_CHARS)
+        {
+            tail_len = OLED_MENU_MAX_LINE_CHARS;
+        }
+        memcpy(span, buffer + field.offset, tail_len);
+        span[tail_len] = '\0';
+
+        int box_x = x < 0 ? 0 : x;
+        display_hal.setDrawColor(0);
+        display_hal.drawBox(box_x, y - top_offset, maxWidth - box_x, box_height);
+        display_hal.setDrawColor(1);
+        display_hal.drawStr(x, y, span);
+        draw_calls += 2;
+    }
+
+    // The field widths are fixed, so the line index stays valid for the new text
+    text_hash = hashText(buffer, bufferSize);
+    line_index.hash = text_hash;
+    last_frame_hash = hashBytes(text_hash, &last_state_hash, sizeof(last_state_hash));
+    frames_drawn++;
+    OLED_MENU_STAGE_END(draw, MENU::structs::RENDER_STAGE::DRAW);
+    flushDisplay();
+}
+
+/// @brief Read the visible lines of a streamed page into its buffer, clamping top_line to the document
+/// @param page Streamed page
+void OledMenu::fillStreamWindow(MENU::structs::menuPageInfo *page)
+{
+    MENU::structs::streamDocument *document = page->stream;
+    char *window = page->buffer;
+    uint16_t capacity = page->target_buffer_size - 1;
+    uint16_t length = 0;
+
+    // A second attempt is only needed when the first one found the end of the document
+    for (uint8_t attempt = 0; attempt < 2; attempt++)
+    {
+        if (document->end_known)
+        {
+            uint32_t last_top = document->num_lines > static_cast<uint32_t>(dispLines) ? document->num_lines - dispLines : 0;
+            if (document->top_line > last_top)
+            {
+                document->top_line = last_top;
+            }
+        }
+
+        uint32_t offset;
+        if (!locateStreamLine(document, document->top_line, window, capacity, offset))
+        {
+            continue;
+        }
+        length = document->reader(offset, window, capacity, document->context);
+        document->bytes_read += length;
+        if (length == 0)
+        {
+            // The line starts at the very end of the document
+            document->end_known = true;
+            document->num_lines = document->top_line;
+            if (document->top_line > 0)
+            {
+                continue;
+            }
+        }
+        break;
+    }
+
+    // Keep the visible lines, a full window is cut after its last complete line
+    uint16_t lines = 0;
+    uint16_t end = 0;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (window[i] == '\n')
+        {
+            end = i + 1;
+            if (++lines == dispLines)
+            {
+                break;
+            }
+        }
+    }
+    if (lines < dispLines && (length < capacity || end == 0))
+    {
+        end = length; // The document ends in the window, or a single line is longer than the buffer
+    }
+    window[end] = '\0';
+    page->needs_buffer_size = end + 1;
+    document->window_line = document->top_line;
+}
+
+/// @brief Find the offset of a line of a streamed document, starting from the nearest checkpoint
+/// @param document Streamed document
+/// @param line Line to find
+/// @param scratch Buffer for the bytes read while scanning
+/// @param scratch_size Size of scratch
+/// @param offset Offset of the line
+/// @return True if the line was found, false if the document ends before it
+bool OledMenu::locateStreamLine(MENU::structs::streamDocument *document, uint32_t line, char *scratch, uint16_t scratch_size, uint32_t &offset)
+{
+    uint32_t checkpoint = line / document->checkpoint_interval;
+    if (checkpoint >= document->num_checkpoints)
+    {
+        checkpoint = document->num_checkpoints - 1;
+    }
+    uint32_t current = checkpoint * document->checkpoint_interval;
+    offset = document->checkpoints[checkpoint];
+
+    uint32_t read_offset = offset;
+    while (current < line)
+    {
+        uint16_t n = document->reader(read_offset, scratch, scratch_size, document->context);
+        document->bytes_read += n;
+        if (n == 0)
+        {
+            // A last line without a trailing newline still counts
+            document->end_known = true;
+            document->num_lines = read_offset > offset ? current + 1 : current;
+            return false;
+        }
+        for (uint16_t i = 0; i < n && current < line; i++)
+        {
+            if (scratch[i] == '\n')
+            {
+                current++;
+                offset = read_offset + i + 1;
+                addStreamCheckpoint(document, current, offset);
+            }
+        }
+        read_offset += n;
+    }
+    return true;
+}
+
+/// @brief Record the offset of a line if it is the next checkpoint, halving the checkpoints when they are full
+/// @param document Streamed document
+/// @param line Line index
+/// @param offset Offset of the line
+void OledMenu::addStreamCheckpoint(MENU::structs::streamDocument *document, uint32_t line, uint32_t offset)
+{
+    if (line % document->checkpoint_interval != 0 || line / document->checkpoint_interval != document->num_checkpoints)
+    {
+        return;
+    }
+    if (document->num_checkpoints == document->max_checkpoints)
+    {
+        // Keep every other checkpoint at twice the interval, so the index covers any document length
+        if (document->checkpoint_interval >= 0x8000)
+        {
+            return;
+        }
+        for (uint16_t i = 0; i < (document->num_checkpoints + 1) / 2; i++)
+        {
+            document->checkpoints[i] = document->checkpoints[i * 2];
+        }
+        document->num_checkpoints = (document->num_checkpoints + 1) / 2;
+        document->checkpoint_interval *= 2;
+        if (line % document->checkpoint_interval != 0)
+        {
+            return;
+        }
+    }
+    document->checkpoints[document->num_checkpoints++] = offset;
+}
+
+/// @brief Copy the visible lines of a log page into its buffer
+/// @param page Log page
+/// @return Number of lines the window moved while following the tail with all lines shown, 0 otherwise
+uint8_t OledMenu::buildLogWindow(MENU::structs::menuPageInfo *page)
+{
+    MENU::structs::logPage *log = page->log;
+    uint16_t visible = log->count < static_cast<uint16_t>(dispLines) ? log->count : dispLines;
+    if (log->scrollback > log->count - visible)
+    {
+        log->scrollback = log->count - visible;
+    }
+
+    // Ring index of the oldest line, and the line of the log at the top of the window
+    uint16_t oldest = (log->head + log->capacity - log->count) % log->capacity;
+    uint16_t first = log->count - log->scrollback - visible;
+    uint16_t limit = page->target_buffer_size - 1;
+    uint16_t pos = 0;
+    bool cut = false;
+    for (uint16_t i = 0; i < visible && !cut; i++)
+    {
+        const char *line = log->lines + ((oldest + first + i) % log->capacity) * log->line_size;
+        size_t length = strnlen(line, log->line_size - 1);
+        uint16_t separator = i > 0 ? 1 : 0;
+        if (pos + separator >= limit)
+        {
+            cut = true;
+            break;
+        }
+        if (pos + separator + length > limit)
+        {
+            cut = true;
+            length = limit - pos - separator;
+        }
+        if (separator != 0)
+        {
+            page->buffer[pos++] = '\n';
+        }
+        memcpy(page->buffer + pos, line, length);
+        pos += length;
+    }
+    page->buffer[pos] = '\0';
+    page->needs_buffer_size = pos + 1;
+
+    // Lines appended while following the tail of a full window only move it, as long as some lines stay
+    uint32_t appended = log->sequence - log->window_sequence;
+    uint8_t moved = 0;
+    if (!cut && log->scrollback == 0 && log->window_scrollback == 0 && visible == static_cast<uint16_t>(dispLines) &&
+        log->window_lines == visible && appended < visible)
+    {
+        moved = appended;
+    }
+    log->window_sequence = log->sequence;
+    log->window_scrollback = log->scrollback;
+    log->window_lines = cut ? 0 : visible;
+    return moved;
+}
+
+/// @brief Check if the last frame can be moved up to show new lines of a log page
+/// @param lines Number of new lines
+/// @return True if the frame can be scrolled, false if it has to be drawn
+bool OledMenu::canScrollLogTail(uint8_t lines)
+{
+    // Same conditions as drawing over the last frame, and the frame buffer rows are moved byte by byte
+    return lines > 0 && canRedrawTemplateFields() && display_hal.getU8g2()->ll_hvline == u8g2_ll_hvline_vertical_top_lsb;
+}
+
+/// @brief Move the last frame up by whole lines, draw the new lines of the log page and flush it
+/// @param lines Number of new lines
+void OledMenu::scrollLogTail(uint8_t lines)
+{
+    OLED_MENU_STAGE_BEGIN(draw);
+    setFontSizeForLineLimits();
+    display_hal.setFontMode(1);
+    const MENU::structs::fontMetrics &metrics = getLineFontMetrics();
+    scrollFrameUp(lines * metrics.line_spacing);
+
+    text_hash = hashText(buffer, bufferSize);
+    buildLineIndex(buffer, bufferSize, text_hash);
+
+    // Lines cut by the bottom edge before the move are missing rows, so they are drawn with the new lines
+    uint16_t first_drawn = line_index.num_lines > lines ? line_index.num_lines - lines : 0;
+    for (uint16_t line = 0; line < first_drawn; line++)
+    {
+        if (page_info->anchorY + (line + lines) * metrics.line_spacing - metrics.descent > static_cast<int>(maxHeight))
+        {
+            first_drawn = line;
+            break;
+        }
+    }
+
+    // Clear above the first line, where the lines that left the window were, and from the first drawn line down
+    int window_top = page_info->anchorY - metrics.ascent;
+    int drawn_top = page_info->anchorY + first_drawn * metrics.line_spacing - metrics.ascent;
+    display_hal.setDrawColor(0);
+    if (window_top > 0)
+    {
+        display_hal.drawBox(0, 0, maxWidth, window_top);
+        draw_calls++;
+    }
+    if (drawn_top < static_cast<int>(maxHeight))
+    {
+        int top = drawn_top < 0 ? 0 : drawn_top;
+        display_hal.drawBox(0, top, maxWidth, maxHeight - top);
+        draw_calls++;
+    }
+    display_hal.setDrawColor(1);
+    for (uint16_t line = first_drawn; line < line_index.num_lines; line++)
+    {
+        drawIndexedLine(line, page_info->anchorX, page_info->anchorY + line * metrics.line_spacing);
+    }
+
+    last_frame_hash = hashBytes(text_hash, &last_state_hash, sizeof(last_state_hash));
+    frames_drawn++;
+    OLED_MENU_STAGE_END(draw, MENU::structs::RENDER_STAGE::DRAW);
+    flushDisplay();
+}
+
+/// @brief Move the frame buffer contents up, clearing the rows moved in at the bottom
+/// @param pixels Number of pixel rows to move
+void OledMenu::scrollFrameUp(uint16_t pixels)
+{
+    uint8_t *frame = display_hal.getBufferPtr();
+    uint8_t tile_rows = display_hal.getBufferTileHeight();
+    uint16_t width = display_hal.getBufferTileWidth() * 8;
+    uint16_t row_shift = pixels / 8;
+    uint8_t bit_shift = pixels % 8;
+
+    // Rows are written top down and only read from the same or lower rows
+    for (uint16_t ty = 0; ty < tile_rows; ty++)
+    {
+        uint8_t *dest = frame + ty * width;
+        uint16_t src = ty + row_shift;
+        const uint8_t *upper = src < tile_rows ? frame + src * width : nullptr;
+        const uint8_t *lower = src + 1 < tile_rows ? frame + (src + 1) * width : nullptr;
+        for (uint16_t x = 0; x < width; x++)
+        {
+            uint8_t value = upper != nullptr ? upper[x] >> bit_shift : 0;
+            if (bit_shift != 0 && lower != nullptr)
+            {
+                value |= lower[x] << (8 - bit_shift);
+            }
+            dest[x] = value;
+        }
+    }
+}
+
+/// @brief Check if the callback of a page is due
+/// @param page Page to check
+/// @param now Current time in milliseconds
+/// @return True if the callback should run, false otherwise
+bool OledMenu::isPageRefreshDue(MENU::structs::menuPageInfo *page, unsigned long now)
+{
+    if (page->stream != nullptr && page->stream->window_line != page->stream->top_line)
+    {
+        return true; // Scrolled, the window has to be read again
+    }
+    if (page->log != nullptr &&
+        (page->log->window_sequence != page->log->sequence || page->log->window_scrollback != page->log->scrollback))
+    {
+        return true; // Appended or scrolled
+    }
+    switch (page->refresh_policy)
+    {
+    case MENU::structs::REFRESH_POLICY::INTERVAL:
+        return page->refresh_requested || now - page->last_refresh >= page->refresh_interval;
+    case MENU::structs::REFRESH_POLICY::ON_DEMAND:
+        return page->refresh_requested;
+    case MENU::structs::REFRESH_POLICY::ON_DATA_CHANGED:
+        return page->refresh_requested || (page->data_version != nullptr && *page->data_version != page->last_data_version);
+    default:
+        return true;
+    }
+}
+
+/// @brief Record that the callback of a page ran
+/// @param page Page that was refreshed
+/// @param now Current time in milliseconds
+void OledMenu::markPageRefreshed(MENU::structs::menuPageInfo *page, unsigned long now)
+{
+    page->last_refresh = now;
+    page->refresh_requested = false;
+    if (page->data_version != nullptr)
+    {
+        page->last_data_version = *page->data_version;
+    }
+}
+
+/// @brief Set when the callback of a page runs.
+/// @param page Index of the page.
+/// @param policy Refresh policy of the page.
+/// @param interval_ms Interval in milliseconds for the INTERVAL policy.
+/// @param data_version Counter watched by the ON_DATA_CHANGED policy, nullptr to rely on requestPageRefresh().
+/// @return True if the policy was set, false if the page does not exist.
+bool OledMenu::setPageRefreshPolicy(uint8_t page, MENU::structs::REFRESH_POLICY policy, uint32_t interval_ms, const volatile uint32_t *data_version)
+{
+    MENU::structs::menuPageInfo *target = getMenuPageInfo(page);
+    if (target == nullptr)
+    {
+        return false;
+    }
+    target->refresh_policy = policy;
+    target->refresh_interval = interval_ms;
+    target->data_version = data_version;
+    target->refresh_requested = true; // Run once under the new policy
+    return true;
+}
+
+/// @brief Request the callback of a page to run on the next refresh, for any policy.
+/// @param page Index of the page.
+void OledMenu::requestPageRefresh(uint8_t page)
+{
+    MENU::structs::menuPageInfo *target = getMenuPageInfo(page);
+    if (target != nullptr)
+    {
+        target->refresh_requested = true;
+    }
+}
+
+/// @brief Get the time until refreshDisplay() next has work to do.
+/// @return Milliseconds until the next refresh is due, 0 if due now, OLED_MENU_NO_DEADLINE if nothing is scheduled.
+uint32_t OledMenu::getNextRefreshDeadline()
+{
+    // Events posted by postInput(), possibly from an interrupt, are applied by the next refresh in any power state
+    if (__atomic_load_n(&input_head, __ATOMIC_ACQUIRE) != input_tail)
+    {
+        return 0;
+    }
+
+    unsigned long now = millis();
+    uint32_t deadline = OLED_MENU_NO_DEADLINE;
+
+    if (idle_policy)
+    {
+        if (power_state == MENU::structs::ASLEEP)
+        {
+            // Nothing is drawn until an input or a new error wakes the display
+            return (idle_activity || error_sequence != power_error_sequence) ? 0 : OLED_MENU_NO_DEADLINE;
+        }
+        deadline = getIdleStepRemaining(now);
+    }
+    if (blinkEnabled)
+    {
+        unsigned long elapsed = now - lastBlinkTime;
+        uint32_t remaining = elapsed >= static_cast<unsigned long>(blinkInterval) ? 0 : blinkInterval - elapsed;
+        if (remaining < deadline)
+        {
+            deadline = remaining;
+        }
+    }
+    if (async_flush && flush_pending_rows != 0)
+    {
+        return 0;
+    }
+    if (error_message_display_override)
+    {
+        return deadline;
+    }
+
+    MENU::structs::menuPageInfo *page = getMenuPageInfo(current_page_displayed);
+    if (page == nullptr)
+    {
+        return deadline;
+    }
+    if (page != last_rendered_page || isPageRefreshDue(page, now))
+    {
+        return 0;
+    }
+    if (page->refresh_policy == MENU::structs::REFRESH_POLICY::INTERVAL)
+    {
+        uint32_t remaining = page->refresh_interval - (now - page->last_refresh);
+        if (remaining < deadline)
+        {
+            deadline = remaining;
+        }
+    }
+    return deadline;
+}
+
+/// @brief Render text for the current error page, formatting the oldest error if it changed
+void OledMenu::renderErrorPageText()
+{
+    // Format the oldest error only when it, or its repeat count, changed since it was last formatted
+    if (num_error > 0)
+    {
+        const MENU::structs::errorRecord &record = error_records[error_head];
+        if (record.id != formatted_error_id || record.count != formatted_error_count)
+        {
+            formatErrorRecord(record, error_buffer_, error_buffer_size);
+            formatted_error_id = record.id;
+            formatted_error_count = record.count;
+        }
+    }
+
+    MENU::structs::errorPageInfo *error_page_info = getErrorPageInfo(current_page_displayed);
+    if (error_page_info == nullptr)
+    {
+        error_page_info = getErrorPageInfo(0);
+    }
+    if (error_page_info != nullptr)
+    {
+        page_info = error_page_info;
+    }
+    else if (page_info == nullptr)
+    {
+        // An error can arrive before any page was rendered, borrow the anchors of the current page
+        page_info = getMenuPageInfo(current_page_displayed);
+        if (page_info == nullptr)
+        {
+            return;
+        }
+    }
+    buffer = error_buffer_;
+    bufferSize = error_buffer_size;
+    displayText(false);
+}
+
+/// @brief Constructor for an arena without memory
+MENU::frameArena::frameArena()
+    : memory_(nullptr), capacity_(0), top_(0), mark_(0), high_water_(0)
+{
+}
+
+/// @brief Give the arena its memory
+/// @param memory Memory to allocate from
+/// @param size Size of the memory
+void MENU::frameArena::init(uint8_t *memory, uint16_t size)
+{
+    memory_ = memory;
+    capacity_ = size;
+    top_ = 0;
+    mark_ = 0;
+    high_water_ = 0;
+}
+
+/// @brief Allocate from the arena
+/// @param size Number of bytes
+/// @return Pointer to the allocation, nullptr if the arena is full
+void *MENU::frameArena::allocate(uint16_t size)
+{
+    // Keep allocations 4-byte aligned, the arena follows the error and page buffers and starts at any address
+    uintptr_t address = (reinterpret_cast<uintptr_t>(memory_ + top_) + 3) & ~static_cast<uintptr_t>(3);
+    uint32_t start = address - reinterpret_cast<uintptr_t>(memory_);
+    if (size == 0 || start > capacity_ || size > capacity_ - start)
+    {
+        return nullptr;
+    }
+    top_ = start + size;
+    if (top_ > high_water_)
+    {
+        high_water_ = top_;
+    }
+    return memory_ + start;
+}
+
+/// @brief Keep everything allocated so far across reset()
+void MENU::frameArena::setMark()
+{
+    mark_ = top_;
+}
+
+/// @brief Free everything allocated after the mark
+void MENU::frameArena::reset()
+{
+    top_ = mark_;
+}
+
+/// @brief Free everything, including what is below the mark
+void MENU::frameArena::release()
+{
+    top_ = 0;
+    mark_ = 0;
+}
+
+/// @brief Check if a pointer is inside the arena
+/// @param ptr Pointer to check
+/// @return True if ptr points into the arena memory
+bool MENU::frameArena::contains(const void *ptr)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(ptr);
+    return memory_ != nullptr && p >= memory_ && p < memory_ + capacity_;
+}
+
+/// @brief Get the number of bytes in use
+/// @return Bytes in use
+uint16_t MENU::frameArena::used()
+{
+    return top_;
+}
+
+/// @brief Get the size of the arena
+/// @return Size in bytes
+uint16_t MENU::frameArena::size()
+{
+    return capacity_;
+}
+
+/// @brief Get the largest number of bytes ever in use
+/// @return High-water mark in bytes
+uint16_t MENU::frameArena::highWater()
+{
+    return high_water_;
 }
 
+#if defined(OLED_MENU_HAS_WIFI)
 /// @brief Function to display connection information on the OLED menu
 /// @param page_info Pointer to the menuPageInfo struct
 void MENU::builtin_pages::connectionInfo(MENU::structs::menuPageInfo *page_info)
@@ -607,8 +3766,10 @@ void MENU::builtin_pages::connectionInfo(MENU::structs::menuPageInfo *page_info)
                        "RSSI: %d\n"
                        "%s\n";
 
-    sprintf(page_info->buffer, page, WiFi.SSID().c_str(), ip[0], ip[1], ip[2], ip[3], WiFi.RSSI(), WiFi.getHostname());
+    page_info->needs_buffer_size = snprintf(page_info->buffer, page_info->target_buffer_size, page, WiFi.SSID().c_str(),
+                                            ip[0], ip[1], ip[2], ip[3], WiFi.RSSI(), WiFi.getHostname()) + 1;
 }
+#endif
 
 /// @brief Function to display OTA update information on the OLED menu
 /// @param page Pointer to the menuPageInfo struct
@@ -618,7 +3779,7 @@ void MENU::builtin_pages::OTAInfo(MENU::structs::menuPageInfo *page)
     static byte spinner = 0;                                    ///< Spinner index
     const char *spinner_text[] = {" | ", " / ", "---", " \\ "}; ///< Spinner text
     const char *page_text = "Updating... %s\n"
-                            "Progress: %lu%%\n%s%s";
+                            "Progress: %d%%\n%s%s";
 
     // Update spinner animation every 100 milliseconds
     if ((millis() - spinner_timer) >= 100)
@@ -627,11 +3788,12 @@ void MENU::builtin_pages::OTAInfo(MENU::structs::menuPageInfo *page)
         spinner_timer = millis();
     }
     uint8_t *parameters = reinterpret_cast<uint8_t *>(page->parameters);
-    // Calculate progress percentage, protect against division by zero
-    int progress = (parameters[0] != 0) ? (parameters[0] / (parameters[1] / 100)) : 0;
+    // Calculate progress percentage of parameters[0] out of parameters[1], protect against division by zero
+    int progress = (parameters[1] != 0) ? (parameters[0] * 100 / parameters[1]) : 0;
 
     // Format the page content with spinner, progress, and status messages
-    int len = sprintf_P(page->buffer, page_text, spinner_text[spinner], progress,
-                        (progress == 100) ? "Update Complete." : "",
-                        (progress == 100) ? "Restarting..." : "");
+    int len = snprintf_P(page->buffer, page->target_buffer_size, page_text, spinner_text[spinner], progress,
+                         (progress == 100) ? "Update Complete." : "",
+                         (progress == 100) ? "Restarting..." : "");
+    page->needs_buffer_size = len + 1;
 }
\ No newline at end of file
@@ -2,18 +2,110 @@
 #define SSD1306_OLED_MENU
 
 #include <Arduino.h>
+#if defined(ESP8266)
 #include <IPAddress.h>
 #include <ESP8266WiFi.h>
 #include <ESP8266mDNS.h>
+#define OLED_MENU_HAS_WIFI 1
+#elif defined(ESP32)
+#include <IPAddress.h>
+#include <WiFi.h>
+#define OLED_MENU_HAS_WIFI 1
+#endif
 #include <U8g2lib.h>
-#include <MemoryManagerLite.h>
-#include <TemplatedLinkedList.h>
 
 // Macro to calculate the number of elements in an array
 #ifndef NELEMS
 #define NELEMS(x) (sizeof(x) / sizeof((x)[0]))
 #endif
 
+// Page table capacity of OledMenu objects created without StaticOledMenu
+#ifndef OLED_MENU_DEFAULT_MAX_PAGES
+#define OLED_MENU_DEFAULT_MAX_PAGES 8
+#endif
+
+// Error page table capacity of OledMenu objects created without StaticOledMenu
+#ifndef OLED_MENU_DEFAULT_MAX_ERROR_PAGES
+#define OLED_MENU_DEFAULT_MAX_ERROR_PAGES 1
+#endif
+
+// Returned by getNextRefreshDeadline() when nothing is scheduled
+#define OLED_MENU_NO_DEADLINE 0xFFFFFFFFUL
+
+// Awake level of setIdlePolicy() that leaves the contrast to the sketch
+#define OLED_MENU_CONTRAST_UNCHANGED -1
+
+// Contrast restored after dimming when setIdlePolicy() has no awake level, the SSD1306 level set by U8g2
+#ifndef OLED_MENU_DEFAULT_CONTRAST
+#define OLED_MENU_DEFAULT_CONTRAST 0xCF
+#endif
+
+// Number of slots of the input queue, must be a power of two from 2 to 256, one slot is kept free
+#ifndef OLED_MENU_INPUT_QUEUE_SIZE
+#define OLED_MENU_INPUT_QUEUE_SIZE 16
+#endif
+// The queue indices are uint8_t and wrap by masking with OLED_MENU_INPUT_QUEUE_SIZE - 1
+static_assert(OLED_MENU_INPUT_QUEUE_SIZE >= 2 && OLED_MENU_INPUT_QUEUE_SIZE <= 256 &&
+                  (OLED_MENU_INPUT_QUEUE_SIZE & (OLED_MENU_INPUT_QUEUE_SIZE - 1)) == 0,
+              "OLED_MENU_INPUT_QUEUE_SIZE must be a power of two from 2 to 256");
+
+// Place functions called from interrupts in IRAM where the core requires it
+#if defined(ESP8266) || defined(ESP32)
+#define OLED_MENU_ISR_ATTR IRAM_ATTR
+#else
+#define OLED_MENU_ISR_ATTR
+#endif
+
+// Number of distinct errors held until acknowledged
+#ifndef OLED_MENU_ERROR_QUEUE_SIZE
+#define OLED_MENU_ERROR_QUEUE_SIZE 4
+#endif
+
+// Maximum number of arguments stored with an error, '*' widths count as arguments
+#ifndef OLED_MENU_ERROR_MAX_ARGS
+#define OLED_MENU_ERROR_MAX_ARGS 6
+#endif
+
+// Bytes stored with an error for the copies of its %s arguments and their terminators, at most 256
+#ifndef OLED_MENU_ERROR_TEXT_SIZE
+#define OLED_MENU_ERROR_TEXT_SIZE 32
+#endif
+
+// Longest conversion specification of an error format plus terminator, a '*' counts as 11 characters
+#ifndef OLED_MENU_ERROR_SPEC_SIZE
+#define OLED_MENU_ERROR_SPEC_SIZE 32
+#endif
+
+// Maximum number of lines indexed for a page
+#ifndef OLED_MENU_MAX_LINES
+#define OLED_MENU_MAX_LINES 32
+#endif
+
+// Maximum number of characters drawn from a single line, at most 255
+#ifndef OLED_MENU_MAX_LINE_CHARS
+#define OLED_MENU_MAX_LINE_CHARS 64
+#endif
+
+// Maximum number of characters reserved for a template field
+#ifndef OLED_MENU_MAX_FIELD_WIDTH
+#define OLED_MENU_MAX_FIELD_WIDTH 24
+#endif
+
+// Define OLED_MENU_ENABLE_STATS for the whole build (build flags, not the sketch) to record render stage timings
+// Number of histogram buckets of a render stage, two per power of two microseconds
+#ifndef OLED_MENU_STATS_BUCKETS
+#define OLED_MENU_STATS_BUCKETS 40
+#endif
+
+// Define OLED_MENU_ENABLE_TRACE for the whole build (build flags, not the sketch) to record hot path trace events
+// Number of events kept by the trace ring, the oldest is overwritten when it is full
+#ifndef OLED_MENU_TRACE_SIZE
+#define OLED_MENU_TRACE_SIZE 64
+#endif
+
+// Maximum number of fields of a template page
+#define OLED_MENU_MAX_TEMPLATE_FIELDS 32
+
 namespace MENU
 {
     namespace structs
@@ -26,6 +118,122 @@ namespace MENU
             _DEFAULT = 2 ///< Default page
         };
 
+        /// @brief Enumeration for when the callback of a page runs
+        enum REFRESH_POLICY
+        {
+            EVERY_CALL = 0,     ///< On every refreshDisplay() call
+            INTERVAL = 1,       ///< Every refresh_interval milliseconds
+            ON_DEMAND = 2,      ///< Only after requestPageRefresh()
+            ON_DATA_CHANGED = 3 ///< When the watched data_version counter changes, or after requestPageRefresh()
+        };
+
+        /// @brief Enumeration for the power state of the display under the idle policy
+        enum POWER_STATE : uint8_t
+        {
+            AWAKE = 0,  ///< Normal contrast, frames are drawn
+            DIMMED = 1, ///< Lowered contrast, frames are drawn
+            ASLEEP = 2  ///< Display switched off, callbacks and drawing are suspended
+        };
+
+        /// @brief Enumeration for navigation input events
+        enum INPUT_EVENT : uint8_t
+        {
+            NEXT_PAGE = 0,     ///< Move to the next page
+            PREVIOUS_PAGE = 1, ///< Move to the previous page
+            ITEM_UP = 2,       ///< Move up an item
+            ITEM_DOWN = 3,     ///< Move down an item
+            ENTER = 4,         ///< Enter the current page
+            EXIT = 5           ///< Exit the current page
+        };
+
+        /// @brief Enumeration for the value types of template fields
+        enum FIELD_TYPE : uint8_t
+        {
+            INT = 0,   ///< int32_t value, right aligned
+            FLOAT = 1, ///< float value with precision decimals, right aligned
+            IP = 2,    ///< uint32_t IPv4 address in network byte order, as IPAddress converts to, left aligned
+            STRING = 3 ///< Character array, left aligned and cut to the field width
+        };
+
+        /// @brief Struct for a value slot of a template page
+        struct templateField
+        {
+            FIELD_TYPE type;             ///< Type of the bound value
+            const volatile void *value;  ///< Bound value, read on every refresh
+            uint8_t width;               ///< Number of characters reserved in the layout
+            uint8_t precision;           ///< Number of decimals of FLOAT fields
+            uint16_t offset;             ///< Offset of the field in the page buffer, set by addTemplatePage()
+            uint8_t line;                ///< Line of the field, set by addTemplatePage()
+            uint32_t last_value;         ///< Raw value, or hash for STRING fields, of the last formatted value
+
+            /// @brief Constructor for a template field
+            /// @param type Type of the bound value
+            /// @param value Bound value
+            /// @param width Number of characters reserved in the layout
+            /// @param precision Number of decimals of FLOAT fields
+            templateField(FIELD_TYPE type, const volatile void *value, uint8_t width, uint8_t precision = 0)
+                : type(type), value(value), width(width), precision(precision), offset(0), line(0), last_value(0)
+            {
+            }
+        };
+
+        /// @brief Typedef for the random access reader of a streamed document
+        /// @return Number of bytes copied to dest, fewer than length only at the end of the document
+        typedef uint16_t (*stream_reader)(uint32_t offset, char *dest, uint16_t length, void *context);
+
+        /// @brief Struct for a document streamed into a page a window at a time
+        struct streamDocument
+        {
+            stream_reader reader;         ///< Reader of the document, e.g. a file on a flash filesystem
+            void *context;                ///< Passed to the reader
+            uint32_t *checkpoints;        ///< Offsets of every checkpoint_interval-th line, caller provided
+            uint16_t max_checkpoints;     ///< Number of entries in checkpoints
+            uint16_t num_checkpoints;     ///< Number of known checkpoints, the first is line 0
+            uint16_t checkpoint_interval; ///< Lines between checkpoints, doubled when the checkpoints are full
+            uint32_t top_line;            ///< First line shown, set it to jump to a line
+            uint32_t window_line;         ///< First line of the window in the page buffer
+            uint32_t num_lines;           ///< Number of lines of the document, only valid if end_known
+            bool end_known;               ///< Whether the end of the document was reached
+            uint32_t bytes_read;          ///< Number of bytes read through the reader
+
+            /// @brief Constructor for a streamed document
+            /// @param reader Reader of the document
+            /// @param context Passed to the reader
+            /// @param checkpoints Storage for the line offset checkpoints, must stay valid while the page exists
+            /// @param max_checkpoints Number of entries in checkpoints
+            /// @param checkpoint_interval Initial number of lines between checkpoints
+            streamDocument(stream_reader reader, void *context, uint32_t *checkpoints, uint16_t max_checkpoints, uint16_t checkpoint_interval = 16)
+                : reader(reader), context(context), checkpoints(checkpoints), max_checkpoints(max_checkpoints), num_checkpoints(0),
+                  checkpoint_interval(checkpoint_interval), top_line(0), window_line(0xFFFFFFFFUL), num_lines(0), end_known(false), bytes_read(0)
+            {
+            }
+        };
+
+        /// @brief Struct for the lines of a log page, a ring that keeps the newest lines
+        struct logPage
+        {
+            char *lines;                ///< capacity slots of line_size characters, caller provided
+            uint16_t capacity;          ///< Number of line slots
+            uint8_t line_size;          ///< Size of a slot, including the terminator
+            uint16_t head;              ///< Slot the next line is written to
+            uint16_t count;             ///< Number of lines kept
+            uint16_t scrollback;        ///< Lines scrolled back from the newest, 0 follows the tail
+            uint32_t sequence;          ///< Number of lines appended
+            uint32_t window_sequence;   ///< Value of sequence when the window was built
+            uint16_t window_scrollback; ///< Value of scrollback when the window was built
+            uint8_t window_lines;       ///< Number of lines in the window, 0 if it was cut by the page buffer
+
+            /// @brief Constructor for a log page
+            /// @param lines Storage for capacity * line_size characters, must stay valid while the page exists
+            /// @param capacity Number of line slots
+            /// @param line_size Size of a slot, including the terminator
+            logPage(char *lines, uint16_t capacity, uint8_t line_size)
+                : lines(lines), capacity(capacity), line_size(line_size), head(0), count(0), scrollback(0), sequence(0),
+                  window_sequence(0), window_scrollback(0), window_lines(0)
+            {
+            }
+        };
+
         /// @brief Forward declaration of menuPageInfo struct
         struct menuPageInfo;
 
@@ -36,13 +244,13 @@ namespace MENU
         struct menuPageInfo
         {
             PAGE_TYPE type;            ///< Type of the page
-            const bool interactive;    ///< Whether the page is interactive
+            bool interactive;          ///< Whether the page is interactive
             menu_callback callback;    ///< Callback function for the page
             bool select_item = false;  ///< Whether an item is selected
             char *buffer;              ///< Buffer for the page content
             uint16_t target_buffer_size; ///< Size of the buffer
             uint16_t needs_buffer_size; ///< Size of the buffer needed
-            void *parameters;          ///< Additional parameters for the page
+            void *parameters = nullptr; ///< Additional parameters for the page
             int anchorX = 0;           ///< X position of the display anchor
             int anchorY = 0;           ///< Y position of the display anchor
             int cursorX = 0;           ///< X position of the cursor
@@ -52,6 +260,23 @@ namespace MENU
             uint16_t num_lines = 0;    ///< Number of lines on the page
             uint16_t chars_on_line = 0; ///< Number of characters on the current line
             uint16_t max_chars_on_line = 0; ///< Maximum number of characters on a line
+            REFRESH_POLICY refresh_policy = EVERY_CALL;        ///< When the callback runs
+            uint32_t refresh_interval = 0;                     ///< Callback interval in milliseconds for INTERVAL
+            uint32_t last_refresh = 0;                         ///< Time the callback last ran
+            bool refresh_requested = false;                    ///< Whether the callback runs on the next refresh
+            const volatile uint32_t *data_version = nullptr;   ///< Counter watched by ON_DATA_CHANGED
+            uint32_t last_data_version = 0;                    ///< Value of data_version when the callback last ran
+            templateField *fields = nullptr;                   ///< Bound fields of a template page, nullptr for callback pages
+            uint8_t num_fields = 0;                            ///< Number of bound fields
+            const char *layout = nullptr;                      ///< Layout of a template page, expanded on page entry
+            streamDocument *stream = nullptr;                  ///< Document of a streamed page, nullptr for other pages
+            logPage *log = nullptr;                            ///< Lines of a log page, nullptr for other pages
+
+            /// @brief Constructor for an empty page table slot
+            menuPageInfo()
+                : type(PAGE_TYPE::_DEFAULT), interactive(false), callback(nullptr), buffer(nullptr), target_buffer_size(0), needs_buffer_size(0)
+            {
+            }
 
             /// @brief Constructor for menuPageInfo
             /// @param page_type Type of the page
@@ -67,13 +292,288 @@ namespace MENU
 
         typedef menuPageInfo errorPageInfo;
 
+        /// @brief Union for a raw error message argument
+        union errorArg
+        {
+            long i;          ///< Signed integer and character arguments
+            unsigned long u; ///< Unsigned integer arguments
+            double f;        ///< Floating point arguments
+            uint8_t text;    ///< Offset of the copy of a string argument in the record text
+            void *p;         ///< Pointer arguments
+        };
+
+        /// @brief Struct for a queued error, formatted only when shown
+        struct errorRecord
+        {
+            const char *fmt;                         ///< Format string of the error
+            errorArg args[OLED_MENU_ERROR_MAX_ARGS]; ///< Raw arguments of the error
+            char text[OLED_MENU_ERROR_TEXT_SIZE];    ///< Copies of the string arguments, each terminated
+            uint8_t argc;                            ///< Number of arguments
+            uint16_t count;                          ///< Number of occurrences
+            uint16_t id;                             ///< Sequence number of the error
+            uint32_t last_time;                      ///< Time of the last occurrence in milliseconds
+        };
+
+        /// @brief Struct for a menu page definition, meant to be stored in flash (PROGMEM)
+        struct menuPageDef
+        {
+            PAGE_TYPE type;          ///< Type of the page
+            bool interactive;        ///< Whether the page is interactive
+            menu_callback callback;  ///< Callback function for the page, nullptr for static pages
+            const char *static_text; ///< Flash text copied into the page buffer, nullptr for callback pages
+            uint16_t buffer_size;    ///< Size of the page buffer
+        };
+
+        /// @brief Struct for the cached metrics of a font
+        struct fontMetrics
+        {
+            int8_t height = 0;       ///< Maximum character height
+            int8_t width = 0;        ///< Maximum character width
+            int8_t ascent = 0;       ///< Ascent above the baseline
+            int8_t descent = 0;      ///< Descent below the baseline, negative
+            int8_t line_spacing = 0; ///< Distance between two baselines
+        };
+
+        /// @brief Struct for the RAM used by an OledMenu configuration
+        struct memoryFootprint
+        {
+            size_t object;         ///< Size of the OledMenu object
+            size_t page_tables;    ///< Size of the menu and error page tables
+            size_t display_buffer; ///< Size of the display buffer
+            size_t text_arena_high_water; ///< Largest use of the text arena
+            size_t frame_buffer;   ///< Size of the U8G2 frame buffer, full or page buffer
+            size_t tile_shadow;    ///< Size of the dirty tile shadow buffer
+            size_t word_wrap;      ///< Size of the word wrap layout cache
+            size_t mirror;         ///< Size of the mirror shadow buffer
+            size_t total;          ///< Total RAM used
+        };
+
+        /// @brief Struct for a slot of the line bitmap cache
+        struct lineCacheEntry
+        {
+            uint32_t hash;      ///< Hash of the line text
+            uint32_t last_used; ///< Cache clock of the last use, 0 for an empty slot
+            int16_t x;          ///< X position the line was captured at
+            int16_t offset;     ///< First captured column relative to x
+            uint16_t width;     ///< Number of captured columns
+            uint8_t length;     ///< Number of characters of the line
+            bool clipped;       ///< Whether the capture was cut by the display edge, only valid at x then
+        };
+
+        /// @brief Enumeration for the stages of the render pipeline
+        enum RENDER_STAGE : uint8_t
+        {
+            CALLBACK = 0,   ///< Page callback or template field update
+            LAYOUT = 1,     ///< Frame fingerprint and line index
+            DRAW = 2,       ///< Drawing into the frame buffer, includes the bus with page buffer constructors
+            FLUSH = 3,      ///< Sending the frame buffer, or queued rows from service()
+            STAGE_COUNT = 4 ///< Number of stages
+        };
+
+        /// @brief Struct for the timing of a render stage
+        struct stageStats
+        {
+            uint32_t count = 0;  ///< Number of recorded runs
+            uint32_t min_us = 0; ///< Shortest run in microseconds
+            uint32_t avg_us = 0; ///< Average run in microseconds
+            uint32_t max_us = 0; ///< Longest run in microseconds
+            uint32_t p99_us = 0; ///< 99th percentile in microseconds, upper bound of its histogram bucket
+        };
+
+        /// @brief Struct for the render pipeline statistics
+        struct renderStats
+        {
+            stageStats stages[STAGE_COUNT]; ///< Timing of every stage
+            float fps = 0;                  ///< Frames drawn per second
+            uint32_t frames_drawn = 0;      ///< Number of frames drawn
+            uint32_t frames_skipped = 0;    ///< Number of unchanged frames that were skipped
+        };
+
+        /// @brief Struct for the running timing of a render stage
+        struct stageAccumulator
+        {
+            uint32_t count = 0;                           ///< Number of recorded runs
+            uint64_t total_us = 0;                        ///< Sum of all runs in microseconds
+            uint32_t min_us = 0;                          ///< Shortest run in microseconds
+            uint32_t max_us = 0;                          ///< Longest run in microseconds
+            uint16_t histogram[OLED_MENU_STATS_BUCKETS] = {}; ///< Runs per duration bucket
+        };
+
+        /// @brief Enumeration for the events of the hot path trace
+        enum TRACE_EVENT : uint8_t
+        {
+            TRACE_REFRESH = 0,      ///< refreshDisplay(), arg is the page shown
+            TRACE_RENDER_PAGE = 1,  ///< renderMenuPageText(), arg is the page index
+            TRACE_RENDER_ERROR = 2, ///< renderErrorPageText(), arg is the number of queued errors
+            TRACE_CALLBACK = 3,     ///< Page callback or template field update, arg is the page index
+            TRACE_DISPLAY_TEXT = 4, ///< displayText(), arg is 1 if the frame was drawn, 0 if skipped
+            TRACE_FLUSH = 5,        ///< Synchronous frame buffer flush, arg is the number of tile rows
+            TRACE_SERVICE = 6,      ///< service(), arg is the number of tile rows sent
+            TRACE_INPUTS = 7,       ///< processInputs() with queued events, arg is the number of events
+            TRACE_MOVE_PAGE = 8,    ///< Page move, instant, arg is the new page
+            TRACE_MOVE_ITEM = 9,    ///< Item move, instant, arg is the new line
+            TRACE_ENTER_PAGE = 10,  ///< Page entered, instant, arg is the page index
+            TRACE_EXIT_PAGE = 11,   ///< Page exited, instant, arg is the page index
+            TRACE_POWER = 12,       ///< Power state change of the idle policy, instant, arg is the new state
+            TRACE_EVENT_COUNT = 13  ///< Number of trace events
+        };
+
+        /// @brief Struct for an event of the hot path trace
+        struct traceRecord
+        {
+            uint32_t start_us = 0;    ///< micros() at the start of the event
+            uint32_t duration_us = 0; ///< Duration in microseconds, 0 for instant events
+            uint16_t arg = 0;         ///< Event argument, see TRACE_EVENT
+            uint8_t event = 0;        ///< Event, one of TRACE_EVENT
+            bool instant = false;     ///< Whether the event is a point in time rather than a span
+        };
+
+        /// @brief Struct for the line offset index of a text buffer
+        struct lineIndex
+        {
+            const char *source = nullptr;          ///< Text the index was built from
+            uint32_t hash = 0;                     ///< Hash of the indexed text
+            uint16_t start[OLED_MENU_MAX_LINES];   ///< Offset of the first character of each line
+            uint8_t length[OLED_MENU_MAX_LINES];   ///< Number of characters on each line
+            uint16_t num_lines = 0;                ///< Number of indexed lines
+            uint16_t max_chars_on_line = 0;        ///< Maximum number of characters on a line
+            uint16_t max_line_width = 0;           ///< Width of the widest line in pixels, 0 if not measured
+            const uint8_t *wrap_font = nullptr;    ///< Font the lines were wrapped with, nullptr if not wrapped
+            uint16_t lines_dropped = 0;            ///< Number of text lines past the last indexed line
+            uint16_t lines_cut = 0;                ///< Number of lines longer than the characters drawn of a line
+        };
+
+        /// @brief Struct for the word wrap layout of the last indexed text, caller provided, see setWordWrap()
+        struct wrapCache
+        {
+            const uint8_t *font = nullptr;                  ///< Font the advances and line breaks were measured with
+            uint16_t width = 0;                             ///< Wrap width of the line breaks
+            uint8_t advance[95];                            ///< Advance of the printable ASCII glyphs of font
+            uint32_t line_hash[OLED_MENU_MAX_LINES];        ///< Hash of every text line
+            uint8_t first_row[OLED_MENU_MAX_LINES];         ///< First wrapped row of every text line
+            uint8_t num_rows[OLED_MENU_MAX_LINES];          ///< Number of wrapped rows of every text line
+            uint16_t line_width[OLED_MENU_MAX_LINES];       ///< Width of the widest row of every text line
+            uint8_t row_start[OLED_MENU_MAX_LINES];         ///< Start of every wrapped row within its text line
+            uint8_t row_length[OLED_MENU_MAX_LINES];        ///< Number of characters of every wrapped row
+            uint16_t num_lines = 0;                         ///< Number of text lines with all their rows laid out
+        };
+
     }; // namespace structs
 
+    /// @brief Bump pointer arena for transient text, rewound once per frame
+    class frameArena
+    {
+    public:
+        /// @brief Constructor for an arena without memory
+        frameArena();
+
+        /// @brief Give the arena its memory
+        /// @param memory Memory to allocate from
+        /// @param size Size of the memory
+        void init(uint8_t *memory, uint16_t size);
+
+        /// @brief Allocate from the arena
+        /// @param size Number of bytes
+        /// @return Pointer to the allocation, nullptr if the arena is full
+        void *allocate(uint16_t size);
+
+        /// @brief Keep everything allocated so far across reset()
+        void setMark();
+
+        /// @brief Free everything allocated after the mark
+        void reset();
+
+        /// @brief Free everything, including what is below the mark
+        void release();
+
+        /// @brief Check if a pointer is inside the arena
+        /// @param ptr Pointer to check
+        /// @return True if ptr points into the arena memory
+        bool contains(const void *ptr);
+
+        /// @brief Get the number of bytes in use
+        /// @return Bytes in use
+        uint16_t used();
+
+        /// @brief Get the size of the arena
+        /// @return Size in bytes
+        uint16_t size();
+
+        /// @brief Get the largest number of bytes ever in use
+        /// @return High-water mark in bytes
+        uint16_t highWater();
+
+    private:
+        uint8_t *memory_;     ///< Arena memory
+        uint16_t capacity_;   ///< Size of the arena memory
+        uint16_t top_;        ///< Offset of the next allocation
+        uint16_t mark_;       ///< Offset reset() rewinds to
+        uint16_t high_water_; ///< Largest top_ seen
+    };
+
+    namespace table
+    {
+        /// @brief Check if a range of a text holds its terminator, at compile time
+        /// @param text Text to check
+        /// @param first Index of the first character of the range
+        /// @param last Index after the last character of the range
+        /// @return True if a character in [first, last) is the terminator
+        /// @note Halves the range so the recursion depth grows with log2 of the length. Left halves are checked
+        ///       first, so no character after the terminator is read.
+        constexpr bool hasTerminator(const char *text, uint16_t first, uint16_t last)
+        {
+            return last - first <= 1 ? last > first && text[first] == '\0'
+                                     : hasTerminator(text, first, first + (last - first) / 2) ||
+                                           hasTerminator(text, first + (last - first) / 2, last);
+        }
+
+        /// @brief Check if a static text fits a buffer, at compile time
+        /// @param text Text to check
+        /// @param size Size of the buffer
+        /// @return True if the text and its terminator fit in size bytes
+        constexpr bool textFits(const char *text, uint16_t size)
+        {
+            return hasTerminator(text, 0, size);
+        }
+
+        /// @brief Check a single page definition, at compile time
+        /// @param def Page definition to check
+        /// @return True if the page definition is valid
+        constexpr bool pageDefValid(const MENU::structs::menuPageDef &def)
+        {
+            return def.buffer_size > 0 &&
+                   (def.callback != nullptr) != (def.static_text != nullptr) &&
+                   (def.static_text == nullptr || textFits(def.static_text, def.buffer_size));
+        }
+
+        /// @brief Check every page definition of a menu table, at compile time
+        /// @param defs Menu table
+        /// @param i Index of the page definition being checked
+        /// @return True if all page definitions are valid
+        template <size_t N>
+        constexpr bool menuTableValid(const MENU::structs::menuPageDef (&defs)[N], size_t i = 0)
+        {
+            return i >= N || (pageDefValid(defs[i]) && menuTableValid(defs, i + 1));
+        }
+
+        /// @brief Calculate the page buffer space a menu table needs, at compile time
+        /// @param defs Menu table
+        /// @param i Index of the first page definition to add
+        /// @return Sum of the buffer sizes of the page definitions
+        template <size_t N>
+        constexpr size_t menuTableBufferSize(const MENU::structs::menuPageDef (&defs)[N], size_t i = 0)
+        {
+            return i >= N ? 0 : defs[i].buffer_size + menuTableBufferSize(defs, i + 1);
+        }
+    };
+
     namespace builtin_pages
     {
+#if defined(OLED_MENU_HAS_WIFI)
         /// @brief Function to display connection information on the OLED menu
         /// @param page_info Pointer to the menuPageInfo struct
         void connectionInfo(MENU::structs::menuPageInfo *page_info);
+#endif
 
         /// @brief Function to display OTA update information on the OLED menu
         /// @param page Pointer to the menuPageInfo struct
@@ -81,19 +581,29 @@ namespace MENU
     };
 };
 
+// Validate a constexpr menu table and declare the page buffers it needs
+#define OLED_MENU_TABLE_BUFFERS(menu_table, buffers_name)                                            \
+    static_assert(MENU::table::menuTableValid(menu_table), #menu_table " has an invalid page"); \
+    char buffers_name[MENU::table::menuTableBufferSize(menu_table)]
+
 /// @brief Class representing the OLED menu with text scrolling functionality
 class OledMenu
 {
 public:
-    MemoryManager *mmptr; ///< Pointer to the memory manager
-    U8G2 &display_hal;    ///< Reference to the U8G2 display object
+    U8G2 &display_hal; ///< Reference to the U8G2 display object
 
-    singlylist<MENU::structs::menuPageInfo, MENU::structs::PAGE_TYPE, bool, MENU::structs::menu_callback, char *, uint16_t> pages;        ///< List of menu pages
-    singlylist<MENU::structs::errorPageInfo, MENU::structs::PAGE_TYPE, bool, MENU::structs::menu_callback, char *, uint16_t> error_pages; ///< List of error pages
+    MENU::structs::menuPageInfo *pages;        ///< Table of menu pages
+    MENU::structs::errorPageInfo *error_pages; ///< Table of error pages
+    uint8_t max_pages;                         ///< Capacity of the menu page table
+    uint8_t max_error_pages;                   ///< Capacity of the error page table
+    uint8_t num_error_pages;                   ///< Number of error pages
+    bool owns_page_tables;                     ///< Whether the page tables were allocated by the constructor
+    bool owns_display_buffer;                  ///< Whether the display buffer was allocated by the constructor
 
-    // display buffer
-    MemoryManager &display_buffer; ///< Reference to the display buffer
+    // display buffer, split into the error region, the page region and the text arena
+    uint8_t *display_buffer;       ///< Display buffer memory
     uint16_t display_buffer_size;  ///< Size of the display buffer
+    MENU::frameArena text_arena;   ///< Arena for setText() copies and per-frame transient text
 
     char *error_buffer_;        ///< Buffer for error messages
     uint16_t error_buffer_size; ///< Size of the error buffer
@@ -101,14 +611,116 @@ public:
     char *page_buffer_;        ///< Buffer for page content
     uint16_t page_buffer_size; ///< Size of the page buffer
 
-    byte num_error;                              ///< Number of errors
-    bool error_message_display_override = false; ///< Flag to override error message display
     uint8_t num_pages;                           ///< Number of pages
+    byte num_error;                              ///< Number of queued errors
+    bool error_message_display_override = false; ///< Flag to override error message display
     byte current_page_displayed;                 ///< Index of the currently displayed page
     bool page_entered;                           ///< Flag indicating if a page is entered
     bool line_blinking;                          ///< Flag indicating if a line is blinking
     bool display_connected;                      ///< Flag indicating if the display is connected
 
+    // Dirty tile tracking variables
+    bool dirty_tile_tracking;     ///< Whether only changed tiles are flushed to the display
+    uint32_t tile_shadow_stale_rows; ///< Bit mask of tile rows whose shadow does not mirror the display
+    uint8_t *tile_shadow_buffer;  ///< Copy of the last frame sent to the display
+    uint16_t tile_shadow_size;    ///< Size of the shadow buffer
+    uint32_t tiles_sent;          ///< Number of tiles flushed to the display
+    uint32_t tiles_skipped;       ///< Number of unchanged tiles not flushed to the display
+
+    // Mirror variables
+    Print *mirror_out;                 ///< Stream the changed tiles of every frame are written to, nullptr if disabled
+    uint8_t *mirror_shadow;            ///< Copy of the last frame written to the mirror
+    uint16_t mirror_shadow_size;       ///< Size of the mirror shadow buffer
+    uint16_t mirror_sequence;          ///< Sequence number of the next mirror frame
+    uint16_t mirror_keyframe_interval; ///< Number of frames between two full frames, 0 for only the first
+    uint16_t mirror_frames_since_key;  ///< Number of frames written since the last full frame
+    bool mirror_keyframe_due;          ///< Whether the next frame is written in full
+    uint32_t mirror_checksum;          ///< Running FNV-1a hash of the frame being written
+    uint32_t mirror_bytes;             ///< Number of bytes written to the mirror
+
+    // Asynchronous flush variables
+    bool async_flush;               ///< Whether frames are queued and sent by service()
+    uint32_t flush_pending_rows;    ///< Bit mask of tile rows still to be sent
+    uint8_t flush_next_row;         ///< Next tile row service() looks at
+    uint8_t flush_rows_per_service; ///< Maximum number of tile rows sent per service() call
+    uint16_t flush_budget_us;       ///< Time budget of a service() call in microseconds
+    uint32_t frames_coalesced;      ///< Number of frames that replaced a frame still in flight
+
+    // Scroll canvas variables
+    uint8_t *scroll_canvas;        ///< Off-screen rendering of the whole page, nullptr if disabled
+    uint16_t scroll_canvas_size;   ///< Size of the scroll canvas memory
+    uint8_t canvas_tile_cols;      ///< Width of the rendered canvas in tiles
+    uint8_t canvas_tile_rows;      ///< Height of the rendered canvas in tiles
+    const char *canvas_source;     ///< Text rendered into the canvas
+    uint32_t canvas_hash;          ///< Hash of the text rendered into the canvas
+    uint8_t canvas_font_index;     ///< Font the canvas was rendered with
+    bool canvas_valid;             ///< Whether the canvas holds a rendered page
+    uint32_t canvas_renders;       ///< Number of times a page was rendered into the canvas
+
+    // Line bitmap cache variables
+    uint8_t *line_cache_memory;                      ///< Memory of the line bitmap cache, nullptr if disabled
+    uint16_t line_cache_size;                        ///< Size of the line bitmap cache memory
+    MENU::structs::lineCacheEntry *line_cache_entries; ///< Slot table at the start of the cache memory
+    uint8_t *line_cache_data;                        ///< Bitmaps of the slots, after the slot table
+    uint8_t line_cache_slots;                        ///< Number of slots for the current font
+    uint8_t line_cache_bands;                        ///< Number of 8 pixel bands of a line bitmap
+    const uint8_t *line_cache_font;                  ///< Font the slots were laid out for
+    uint32_t line_cache_clock;                       ///< Use counter for least recently used eviction
+    uint32_t line_cache_hits;                        ///< Number of lines copied from the cache
+    uint32_t line_cache_misses;                      ///< Number of lines drawn with drawStr()
+
+    // Frame fingerprint variables
+    uint32_t last_frame_hash; ///< Fingerprint of the last frame drawn
+    uint32_t text_hash;       ///< Hash of the text of the frame being drawn
+    uint32_t last_state_hash; ///< Hash of the render state of the last frame, without the text
+    MENU::structs::menuPageInfo *last_rendered_page; ///< Page shown by the last renderMenuPageText()
+    bool frame_hash_valid;    ///< Whether last_frame_hash describes the display contents
+    uint32_t frames_drawn;    ///< Number of frames drawn and flushed
+    uint32_t frames_skipped;  ///< Number of unchanged frames that were not drawn
+    uint32_t draw_calls;      ///< Number of U8G2 draw calls made while rendering frames
+
+#if defined(OLED_MENU_ENABLE_STATS)
+    // Render statistics variables
+    MENU::structs::stageAccumulator stage_timing[MENU::structs::STAGE_COUNT]; ///< Timing of every render stage
+    unsigned long stats_start;      ///< Time the statistics were reset in milliseconds
+    uint32_t stats_frames_drawn;    ///< Frames drawn when the statistics were reset
+    uint32_t stats_frames_skipped;  ///< Frames skipped when the statistics were reset
+    uint32_t flush_frame_us = 0;    ///< Time service() spent on the frame in flight so far
+#endif
+
+#if defined(OLED_MENU_ENABLE_TRACE)
+    // Hot path trace variables
+    MENU::structs::traceRecord trace_ring[OLED_MENU_TRACE_SIZE]; ///< Ring of the latest trace events
+    uint16_t trace_head;     ///< Index the next trace event is written to
+    uint32_t trace_recorded; ///< Number of trace events recorded since the last clear
+#endif
+
+    // Error queue, oldest first
+    MENU::structs::errorRecord error_records[OLED_MENU_ERROR_QUEUE_SIZE]; ///< Ring of queued errors
+    uint8_t error_head;               ///< Index of the oldest queued error
+    uint16_t error_sequence;          ///< Sequence number of the last queued error
+    uint16_t errors_dropped;          ///< Number of errors dropped on a full queue
+    uint16_t formatted_error_id;      ///< Sequence number of the error in error_buffer_
+    uint16_t formatted_error_count;   ///< Occurrence count of the error in error_buffer_
+
+    // Input event queue, single producer (may be an interrupt) and single consumer (refreshDisplay)
+    uint8_t input_queue[OLED_MENU_INPUT_QUEUE_SIZE]; ///< Ring buffer of input events
+    uint8_t input_head;                              ///< Next slot written by postInput()
+    uint8_t input_tail;                              ///< Next slot read by processInputs()
+    uint16_t inputs_dropped;                         ///< Number of input events dropped on a full queue
+
+    // Idle power policy variables
+    bool idle_policy;                       ///< Whether the idle policy dims and switches off the display
+    uint32_t idle_dim_ms;                   ///< Idle time before the contrast is lowered, 0 to never dim
+    uint32_t idle_sleep_ms;                 ///< Idle time before the display is switched off, 0 to never sleep
+    uint8_t dim_contrast;                   ///< Contrast while dimmed
+    int16_t awake_contrast;                 ///< Contrast while awake, OLED_MENU_CONTRAST_UNCHANGED to leave it alone
+    bool contrast_lowered;                  ///< Whether the display still has the dim contrast
+    MENU::structs::POWER_STATE power_state; ///< Power state of the display
+    bool idle_activity;                     ///< Whether there was activity since the idle policy last looked
+    unsigned long last_activity;            ///< millis() of the last activity
+    uint16_t power_error_sequence;          ///< Last error sequence number seen by the idle policy
+
     MENU::structs::menuPageInfo *page_info; ///< Pointer to the current page info
 
     // Text scroller variables
@@ -127,12 +739,33 @@ public:
     const uint8_t fontMaxPixelHeight = 23;     ///< Maximum font pixel height
     const uint8_t *u8g2_font_lookup_table[21]; ///< Lookup table for fonts
 
+    MENU::structs::fontMetrics font_metrics[22]; ///< Metrics of the lookup table fonts, the last entry is the fallback font
+    bool font_metrics_valid;                     ///< Whether font_metrics has been measured
+    uint8_t line_font_index;                     ///< Index of the font selected for the number of display lines
+
+    MENU::structs::lineIndex line_index; ///< Line offsets of the text being displayed
+    MENU::structs::wrapCache *wrap_cache; ///< Word wrap layout of the last text, caller provided, nullptr if lines are not wrapped
+
     /// @brief Constructor for OledMenu
     /// @param display Reference to the U8G2 display object
-    /// @param buffer_size Size of the display buffer
+    /// @param buffer_size Size of the display buffer, a quarter holds error text, a quarter is the shared page buffer and the rest is the text arena
     /// @param text_blink_delay Delay for text blinking
     OledMenu(U8G2 &display, uint16_t buffer_size, uint32_t text_blink_delay);
 
+    /// @brief Constructor for OledMenu using caller provided page tables
+    /// @param display Reference to the U8G2 display object
+    /// @param buffer_size Size of the display buffer
+    /// @param text_blink_delay Delay for text blinking
+    /// @param page_table Storage for the menu pages
+    /// @param page_table_size Number of entries in page_table
+    /// @param error_page_table Storage for the error pages
+    /// @param error_page_table_size Number of entries in error_page_table
+    /// @param display_buffer_memory Storage for the display buffer of buffer_size bytes, nullptr to allocate it
+    OledMenu(U8G2 &display, uint16_t buffer_size, uint32_t text_blink_delay,
+             MENU::structs::menuPageInfo *page_table, uint8_t page_table_size,
+             MENU::structs::errorPageInfo *error_page_table, uint8_t error_page_table_size,
+             uint8_t *display_buffer_memory = nullptr);
+
     /// @brief Destructor for OledMenu
     ~OledMenu();
 
@@ -168,37 +801,69 @@ public:
     int getNumberOfDisplayLines();
 
     /// @brief Show an error message
-    /// @param fmt Format string for the error message
+    /// @param fmt Format string for the error message, must stay valid until the error is acknowledged
     /// @param ... Additional arguments for the format string
-    /// @return Length of the error message
+    /// @return Number of occurrences of this error, -1 if the format string is not supported or the error
+    ///         queue is full
+    /// @note The arguments are stored and formatted when the error page is shown, so the return value is no
+    ///       longer the length of the message. Strings are copied into OLED_MENU_ERROR_TEXT_SIZE bytes per
+    ///       error and cut when they do not fit. Repeats of a queued error, same format and same argument
+    ///       values, are counted instead of queued. long long, %n, wide characters and strings (%lc, %ls)
+    ///       and conversion specifications longer than OLED_MENU_ERROR_SPEC_SIZE are not supported.
     int showErrorMessage(const char *fmt, ...);
 
+    /// @brief Get the number of errors dropped because the error queue was full.
+    /// @return Number of dropped errors.
+    uint16_t getErrorsDropped();
+
     /// @brief Check if there is an active error
     /// @return True if there is an active error, false otherwise
     bool hasActiveError();
 
-    /// @brief Acknowledge an error
+    /// @brief Acknowledge the oldest queued error
     void acknowledgeError();
 
     /// @brief Set the text to be displayed and scrolled.
     /// @param txt The text to be displayed.
+    /// @note Only the first OLED_MENU_MAX_LINES lines are shown and every line is cut after
+    ///       OLED_MENU_MAX_LINE_CHARS characters, see getLinesDropped() and getLinesCut().
+    /// @note The copy reuses the whole text arena, pointers from allocateFrameText() are no longer valid.
     void setText(const char *txt);
 
     /// @brief Set the text to be displayed and scrolled using an external buffer.
     /// @param buf The buffer to hold the text.
     /// @param bufSize The size of the buffer.
+    /// @note Only the first OLED_MENU_MAX_LINES lines are shown and every line is cut after
+    ///       OLED_MENU_MAX_LINE_CHARS characters, see getLinesDropped() and getLinesCut().
     void setText(char *buf, size_t bufSize);
 
+    /// @brief Get the number of lines of the displayed text that were not shown because the text has more than
+    ///        OLED_MENU_MAX_LINES lines, or wrapped rows with word wrap enabled.
+    /// @return Number of lines missing at the end of the displayed text.
+    uint16_t getLinesDropped();
+
+    /// @brief Get the number of lines of the displayed text that are longer than OLED_MENU_MAX_LINE_CHARS
+    ///        characters, or 255 characters with word wrap enabled, and were shown cut.
+    /// @return Number of cut lines.
+    uint16_t getLinesCut();
+
     /// @brief Blink the text at the cursor position.
     void blinkTextAtCursorPosition();
 
     /// @brief Display text on the screen
     /// @param showCursor Whether to show the cursor.
+    /// @note With a page buffer (_1/_2) U8G2 constructor the frame is drawn through a firstPage()/nextPage() loop.
     void displayText(bool showCursor = false);
 
-    /// @brief Clear the display buffer
+    /// @brief Clear the display buffer, releasing all text held in the text arena
     void clearDisplayBuffer();
 
+    /// @brief Allocate transient text memory that is valid until the next refreshDisplay() call.
+    /// @param size Number of bytes.
+    /// @return Pointer to the memory, nullptr if the text arena is full.
+    /// @note setText(const char *) and clearDisplayBuffer() release the memory earlier.
+    char *allocateFrameText(uint16_t size);
+
     /// @brief Refresh the display
     void refreshDisplay();
 
@@ -214,13 +879,85 @@ public:
     /// @param page_buffer Buffer for the page content
     /// @param target_buffer_size Size of the page buffer
     /// @return True if the page was added successfully, false otherwise
+    /// @note Only the first OLED_MENU_MAX_LINES lines of the page are shown and every line is cut after
+    ///       OLED_MENU_MAX_LINE_CHARS characters, see getLinesDropped() and getLinesCut().
     bool addMenuPage(MENU::structs::PAGE_TYPE type, bool interactive, MENU::structs::menu_callback callback, char *page_buffer, uint16_t target_buffer_size);
 
+    /// @brief Add a template page whose fields are bound to variables
+    /// @param interactive Whether the page is interactive
+    /// @param layout Static page text, every "{}" is replaced by the next field, must stay valid while the page exists
+    /// @param fields Bound fields, in layout order, must stay valid while the page exists
+    /// @param num_fields Number of fields
+    /// @param page_buffer Buffer for the page content, nullptr to use the shared page buffer
+    /// @param target_buffer_size Size of the page buffer
+    /// @return True if the page was added successfully, false otherwise
+    /// @note Only fields whose value changed are formatted. On a full frame buffer display the static text is
+    ///       drawn on page entry and later frames only redraw the changed fields and the rest of their line.
+    ///       The layout is expanded again on every page entry, so the shared page buffer can be used.
+    bool addTemplatePage(bool interactive, const char *layout, MENU::structs::templateField *fields, uint8_t num_fields,
+                         char *page_buffer, uint16_t target_buffer_size);
+
+    /// @brief Add a page that streams a document larger than RAM through a reader, one window at a time
+    /// @param interactive Whether the page is interactive
+    /// @param document Streamed document, must stay valid while the page exists
+    /// @param page_buffer Buffer for the visible window, nullptr to use the shared page buffer
+    /// @param target_buffer_size Size of the page buffer
+    /// @return True if the page was added successfully, false otherwise
+    /// @note Item moves scroll the document by lines. The window is read again when top_line changes or after
+    ///       requestPageRefresh(), e.g. when the document was appended to. Jumps start from the nearest checkpoint,
+    ///       so they read at most checkpoint_interval lines before the window.
+    bool addStreamPage(bool interactive, MENU::structs::streamDocument *document, char *page_buffer, uint16_t target_buffer_size);
+
+    /// @brief Add a page that shows the newest lines of a log
+    /// @param interactive Whether the page is interactive
+    /// @param log Lines of the log, must stay valid while the page exists
+    /// @param page_buffer Buffer for the visible lines, nullptr to use the shared page buffer
+    /// @param target_buffer_size Size of the page buffer
+    /// @return True if the page was added successfully, false otherwise
+    /// @note The page follows the newest line. Item moves scroll back and forth, moving down to the newest
+    ///       line follows it again. While following, new lines on a full frame buffer display move the last
+    ///       frame up and only the new lines are drawn.
+    bool addLogPage(bool interactive, MENU::structs::logPage *log, char *page_buffer, uint16_t target_buffer_size);
+
+    /// @brief Append a line to a log, overwriting the oldest line when the log is full
+    /// @param log Log to append to
+    /// @param fmt Format string of the line, a line break ends the line
+    /// @param ... Additional arguments for the format string
+    /// @return True if the line was appended, false if the log has no storage
+    static bool appendLog(MENU::structs::logPage *log, const char *fmt, ...);
+
+    /// @brief Load the menu pages from a table of page definitions stored in flash
+    /// @param table Page definitions, in PROGMEM
+    /// @param count Number of page definitions
+    /// @param page_buffers Buffer split into the page buffers, see OLED_MENU_TABLE_BUFFERS
+    /// @param page_buffers_size Size of page_buffers
+    /// @return True if all pages were loaded, false otherwise
+    /// @note Page callbacks are not called, pages are populated on their first render.
+    bool loadMenuTable(const MENU::structs::menuPageDef *table, uint8_t count, char *page_buffers, size_t page_buffers_size);
+
     /// @brief Add an error page to the menu
     /// @param callback Callback function for the error page
     /// @return True if the error page was added successfully, false otherwise
     bool addErrorPage(MENU::structs::menu_callback callback);
 
+    /// @brief Set when the callback of a page runs.
+    /// @param page Index of the page.
+    /// @param policy Refresh policy of the page.
+    /// @param interval_ms Interval in milliseconds for the INTERVAL policy.
+    /// @param data_version Counter watched by the ON_DATA_CHANGED policy, nullptr to rely on requestPageRefresh().
+    /// @return True if the policy was set, false if the page does not exist.
+    bool setPageRefreshPolicy(uint8_t page, MENU::structs::REFRESH_POLICY policy, uint32_t interval_ms = 0, const volatile uint32_t *data_version = nullptr);
+
+    /// @brief Request the callback of a page to run on the next refresh, for any policy.
+    /// @param page Index of the page.
+    void requestPageRefresh(uint8_t page);
+
+    /// @brief Get the time until refreshDisplay() next has work to do.
+    /// @return Milliseconds until the next refresh is due, 0 if due now, OLED_MENU_NO_DEADLINE if nothing is scheduled.
+    /// @note ON_DATA_CHANGED counters are only checked when called, a change is reported as due now. Queued
+    ///       input events are due now as well.
+    uint32_t getNextRefreshDeadline();
+
     /// @brief Move to the next page
     void moveToNextPage();
 
@@ -233,6 +970,49 @@ public:
     /// @brief Move down an item in the menu
     void moveDownMenuItem();
 
+    /// @brief Move a number of pages forward or back, wrapping around
+    /// @param delta Number of pages to move, negative to move back
+    void movePageBy(int delta);
+
+    /// @brief Move a number of items down or up in the current page, wrapping around
+    /// @param delta Number of items to move, negative to move up
+    void moveMenuItemBy(int delta);
+
+    /// @brief Post an input event, safe to call from an interrupt.
+    /// @param event Input event.
+    /// @return True if the event was queued, false if the queue is full.
+    bool postInput(MENU::structs::INPUT_EVENT event);
+
+    /// @brief Apply the queued input events, coalescing consecutive moves.
+    /// @return Number of events processed.
+    /// @note Called by refreshDisplay(), so bursts cost a single render.
+    uint8_t processInputs();
+
+    /// @brief Get the number of input events dropped because the queue was full.
+    /// @return Number of dropped input events.
+    uint16_t getInputsDropped();
+
+    /// @brief Dim and switch off the display when there is no activity.
+    /// @param dim_after_ms Idle time before the contrast is lowered, 0 to never dim.
+    /// @param sleep_after_ms Idle time before the display is switched off with setPowerSave(1), 0 to never sleep.
+    /// @param dim_level Contrast while dimmed.
+    /// @param awake_level Contrast while awake, OLED_MENU_CONTRAST_UNCHANGED to keep the contrast the sketch set.
+    /// @return True if the idle policy is active, false otherwise.
+    /// @note Page moves, enter, exit and new errors are activity. While asleep refreshDisplay() runs no
+    ///       callbacks and draws nothing. The panel keeps the last frame in its RAM, so waking shows it
+    ///       at once, before the callback of the page runs.
+    /// @note U8g2 cannot read the contrast back. Without awake_level, waking from dimmed sets
+    ///       OLED_MENU_DEFAULT_CONTRAST, so a sketch with its own contrast that dims passes it as awake_level.
+    bool setIdlePolicy(uint32_t dim_after_ms, uint32_t sleep_after_ms, uint8_t dim_level = 0,
+                       int16_t awake_level = OLED_MENU_CONTRAST_UNCHANGED);
+
+    /// @brief Count as activity, the display wakes on the next refreshDisplay().
+    void wakeDisplay();
+
+    /// @brief Get the power state of the display.
+    /// @return Power state.
+    MENU::structs::POWER_STATE getPowerState();
+
     /// @brief Clear the page buffer
     void clearPageBuffer();
 
@@ -251,6 +1031,153 @@ public:
     /// @return True if the page was entered successfully, false otherwise
     bool enterCurrentPage();
 
+    /// @brief Enable or disable dirty tile tracking.
+    /// @param enable True to flush only the 8x8 tiles that changed since the last frame.
+    /// @return True if dirty tile tracking is active, false otherwise.
+    /// @note Requires a full frame buffer U8G2 constructor (_F_).
+    bool setDirtyTileTracking(bool enable);
+
+    /// @brief Enable or disable word wrap.
+    /// @param cache Layout cache to wrap page text at spaces to the display width, nullptr to clip long lines.
+    ///              Must stay valid while word wrap is enabled.
+    /// @return True if word wrap is active, false otherwise.
+    /// @note Lines are measured with the glyph advances of the line font, cached per font. Only text lines
+    ///       whose text changed since the last layout are wrapped again. Template fields are then always
+    ///       drawn with the full page, and log pages do not scroll the last frame.
+    /// @note Line navigation moves by wrapped rows, the lines as shown on the display, not by text lines.
+    bool setWordWrap(MENU::structs::wrapCache *cache);
+
+    /// @brief Get the number of tiles flushed to the display.
+    /// @return Number of tiles sent.
+    uint32_t getTilesSent();
+
+    /// @brief Get the number of unchanged tiles that were not flushed.
+    /// @return Number of tiles skipped.
+    uint32_t getTilesSkipped();
+
+    /// @brief Reset the tile sent and skipped counters.
+    void resetTileCounters();
+
+    /// @brief Write the changed tiles of every frame to a stream, to mirror the display on a host.
+    /// @param out Stream to write to, for example Serial or a WiFiClient, nullptr to disable the mirror.
+    /// @param keyframe_interval Number of frames between two full frames, 0 to write only the first in full.
+    /// @return True if the mirror is active, false otherwise.
+    /// @note Requires a full frame buffer U8G2 constructor (_F_). Each frame is written as
+    ///       0xA5 0x5A, type ('K' full, 'D' delta), sequence (u16), tile columns, tile rows, layout
+    ///       (0 vertical tiles, 1 horizontal rows), then for every run of changed tiles of a tile row:
+    ///       column, row, number of tiles and their bytes PackBits encoded. 0xFF ends the runs, followed
+    ///       by the FNV-1a hash (u32) of the bytes from the type on. Values are little endian. Frames
+    ///       without a changed tile are not written. extras/mirror_decode.py rebuilds the frames.
+    bool setMirror(Print *out, uint16_t keyframe_interval = 0);
+
+    /// @brief Write the next mirror frame in full, for example after the host reconnected.
+    void requestMirrorKeyframe();
+
+    /// @brief Get the number of bytes written to the mirror.
+    /// @return Number of mirror bytes.
+    uint32_t getMirrorBytes();
+
+    /// @brief Enable or disable the asynchronous flush.
+    /// @param enable True to queue frames in refreshDisplay() and send them from service().
+    /// @param rows_per_service Maximum number of tile rows sent per service() call.
+    /// @param budget_us Time budget of a service() call in microseconds, 0 for no budget.
+    /// @return True if the asynchronous flush is active, false otherwise.
+    /// @note Requires a full frame buffer U8G2 constructor (_F_) with at most 32 tile rows.
+    bool setAsyncFlush(bool enable, uint8_t rows_per_service = 2, uint16_t budget_us = 0);
+
+    /// @brief Send queued tile rows to the display within the configured limits.
+    /// @return Number of tile rows sent.
+    /// @note Call from loop(), a newer frame queued while one is in flight replaces it. With
+    ///       OLED_MENU_ENABLE_STATS the calls that send a frame are recorded as one FLUSH sample.
+    uint8_t service();
+
+    /// @brief Check if a frame is still being sent by service().
+    /// @return True if tile rows are still queued, false otherwise.
+    bool isFlushInProgress();
+
+    /// @brief Get the number of frames that replaced a frame still in flight.
+    /// @return Number of coalesced frames.
+    uint32_t getFramesCoalesced();
+
+    /// @brief Use an off-screen canvas for scrolling pages.
+    /// @param canvas Memory for the canvas, nullptr to disable it.
+    /// @param size Size of the canvas memory.
+    /// @return True if the scroll canvas is active, false otherwise.
+    /// @note Requires a full frame buffer U8G2 constructor (_F_). A page is rendered into the canvas once, frames
+    ///       that only move the anchor copy a window of it into the frame buffer. Pages that do not fit, highlighted
+    ///       text and the cursor are drawn directly. Canvas widths over 248 pixels need 16 bit U8G2 coordinates.
+    bool setScrollCanvas(uint8_t *canvas, uint16_t size);
+
+    /// @brief Get the number of times a page was rendered into the scroll canvas.
+    /// @return Number of canvas renders.
+    uint32_t getCanvasRenders();
+
+    /// @brief Cache the bitmaps of drawn lines, so unchanged lines are copied instead of decoded from the font.
+    /// @param memory Memory for the cache, nullptr to disable it.
+    /// @param size Size of the cache memory, holds as many lines of the display width as fit.
+    /// @return True if the line cache is active, false otherwise.
+    /// @note Requires a full frame buffer U8G2 constructor (_F_). Least recently used lines are evicted, the
+    ///       cache is emptied when the line font changes. Lines cut by the top or bottom edge are not cached.
+    bool setLineCache(uint8_t *memory, uint16_t size);
+
+    /// @brief Get the number of lines copied from the line cache.
+    /// @return Number of cache hits.
+    uint32_t getLineCacheHits();
+
+    /// @brief Get the number of lines drawn from the font while the line cache was enabled.
+    /// @return Number of cache misses.
+    uint32_t getLineCacheMisses();
+
+    /// @brief Force the next frame to be drawn even if its content did not change
+    void invalidateDisplay();
+
+    /// @brief Get the number of frames drawn and flushed.
+    /// @return Number of frames drawn.
+    uint32_t getFramesDrawn();
+
+    /// @brief Get the number of unchanged frames that were skipped.
+    /// @return Number of frames skipped.
+    uint32_t getFramesSkipped();
+
+    /// @brief Get the number of U8G2 draw calls made while rendering frames.
+    /// @return Number of draw calls.
+    /// @note Lines copied from the line cache or the scroll canvas are not draw calls.
+    uint32_t getDrawCalls();
+
+#if defined(OLED_MENU_ENABLE_STATS)
+    /// @brief Get the render pipeline statistics since the last reset.
+    /// @return Timing of every stage, frames per second and frame counts.
+    MENU::structs::renderStats getRenderStats();
+
+    /// @brief Print the render pipeline statistics on one line, min/avg/max/p99 in microseconds per stage.
+    /// @param out Print object to write to.
+    void printRenderStats(Print &out);
+
+    /// @brief Reset the render pipeline statistics.
+    void resetRenderStats();
+#endif
+
+#if defined(OLED_MENU_ENABLE_TRACE)
+    /// @brief Write the trace ring as Chrome trace_event JSON, load it in chrome://tracing or Perfetto.
+    /// @param out Print object to write to, e.g. Serial or a file on host builds.
+    void writeChromeTrace(Print &out);
+
+    /// @brief Discard the recorded trace events.
+    void clearTrace();
+
+    /// @brief Get the number of trace events overwritten since the last clear.
+    /// @return Number of events lost because the ring was full.
+    uint32_t getTraceOverwritten();
+#endif
+
+    /// @brief Get the RAM used by this menu configuration.
+    /// @return RAM footprint.
+    MENU::structs::memoryFootprint getMemoryFootprint();
+
+    /// @brief Print the RAM used by this menu configuration on one line.
+    /// @param out Print object to write to.
+    void printMemoryFootprint(Print &out);
+
     /// @brief Get the current X position of the cursor.
     /// @return The X position of the cursor.
     int getCursorXPosition();
@@ -262,13 +1189,101 @@ public:
 private:
     uint16_t maxWidth; ///< Maximum width of the display
     uint16_t maxHeight; ///< Maximum height of the display
-    uint8_t calculateMaxCharsOnLine(char *buffer, uint16_t buffer_size);
+
+    /// @brief Index the line starts and lengths of a text buffer, without modifying it
+    /// @param text Text to index
+    /// @param size Size of the text buffer
+    /// @param hash Hash of the text, used to detect when the index is stale
+    void buildLineIndex(const char *text, uint16_t size, uint32_t hash);
+
+    /// @brief Add the wrapped rows of a text line to the line index, reusing the last layout if the line is unchanged
+    /// @param text Indexed text
+    /// @param start Offset of the first character of the line
+    /// @param chars Number of characters of the line
+    /// @param text_line Index of the line in the text
+    /// @return True if all rows of the line fit in the line index, false otherwise
+    bool indexWrappedLine(const char *text, uint16_t start, uint16_t chars, uint16_t text_line);
+
+    /// @brief Measure the glyph advances of the line font for word wrap, if they are not measured yet
+    void prepareWrapCache();
+
+    /// @brief Get the advance of a glyph of the line font
+    /// @param c Character
+    /// @return Advance in pixels
+    uint8_t glyphAdvance(uint8_t c);
+
+    /// @brief Draw the indexed lines that intersect a horizontal band of the display
+    /// @param showCursor Whether to show the cursor.
+    /// @param top Y position of the top of the band
+    /// @param bottom Y position below the bottom of the band
+    void drawText(bool showCursor, int top, int bottom);
+
+    /// @brief Check if the display uses a page buffer (_1/_2) constructor
+    /// @return True if the frame buffer holds only a strip of the display, false otherwise
+    bool isPageBufferMode();
+
+    /// @brief Draw a line through the line cache
+    /// @param text Line text
+    /// @param len Number of characters
+    /// @param x X position of the line
+    /// @param y Y position of the baseline
+    /// @return True if the line was drawn, false if it has to be drawn directly
+    bool drawCachedLine(const char *text, uint8_t len, int x, int y);
+
+    /// @brief Lay out the line cache slots for a font, emptying the cache
+    /// @param font Font of the lines to cache
+    void layoutLineCache(const uint8_t *font);
+
+    /// @brief Read 8 pixel rows of a frame buffer column, starting at any row
+    /// @param col Column
+    /// @param top First pixel row
+    /// @return Pixels, top row in bit 0
+    uint8_t readFrameColumn(uint16_t col, int top);
+
+    /// @brief Set 8 pixel rows of a frame buffer column, starting at any row
+    /// @param col Column
+    /// @param top First pixel row
+    /// @param bits Pixels to set, top row in bit 0
+    void orFrameColumn(uint16_t col, int top, uint8_t bits);
+
+    /// @brief Make sure the scroll canvas holds the text being displayed, rendering it if needed
+    /// @return True if the frame can be copied from the canvas, false if it has to be drawn directly
+    bool prepareScrollCanvas();
+
+    /// @brief Render the indexed text into the scroll canvas, one display sized window at a time
+    /// @param cols Width of the canvas in tiles
+    /// @param rows Height of the canvas in tiles
+    void renderScrollCanvas(uint8_t cols, uint8_t rows);
+
+    /// @brief Copy the window of the scroll canvas at the page anchor into the frame buffer
+    void blitScrollCanvas();
+
+    /// @brief Draw a single indexed line
+    /// @param line Index of the line
+    /// @param x X position of the line
+    /// @param y Y position of the baseline
+    void drawIndexedLine(uint16_t line, int x, int y);
+
     /// @brief Manage the blinking state of the cursor.
     void manageCursorBlink();
 
-    /// @brief Set the font size based on the number of lines to be displayed.
+    /// @brief Set the font size based on the number of lines to be displayed, if it is not already active.
     void setFontSizeForLineLimits();
 
+    /// @brief Select the font for the number of lines to be displayed.
+    void selectLineFont();
+
+    /// @brief Get the font selected for the number of lines to be displayed.
+    /// @return Pointer to the font.
+    const uint8_t *getLineFont();
+
+    /// @brief Get the metrics of the font selected for the number of lines to be displayed.
+    /// @return Cached font metrics.
+    const MENU::structs::fontMetrics &getLineFontMetrics();
+
+    /// @brief Measure the metrics of all lookup table fonts once.
+    void buildFontMetrics();
+
     /// @brief Get the width of a character in the current font.
     /// @return The width of a character.
     int getFontCharacterWidth();
@@ -283,11 +1298,234 @@ private:
     /// @return Pointer to the error page info
     MENU::structs::errorPageInfo *getErrorPageInfo(uint8_t page);
 
-    /// @brief Render text for the current menu page
+#if defined(OLED_MENU_ENABLE_STATS)
+    /// @brief Record the duration of a render stage
+    /// @param stage Render stage
+    /// @param us Duration in microseconds
+    void recordStageTime(MENU::structs::RENDER_STAGE stage, uint32_t us);
+
+    /// @brief Get the histogram bucket of a duration
+    /// @param us Duration in microseconds
+    /// @return Index of the bucket
+    static uint8_t stageBucket(uint32_t us);
+
+    /// @brief Get the longest duration of a histogram bucket
+    /// @param bucket Index of the bucket
+    /// @return Duration in microseconds
+    static uint32_t stageBucketLimit(uint8_t bucket);
+#endif
+
+#if defined(OLED_MENU_ENABLE_TRACE)
+    /// @brief Record a trace event, overwriting the oldest when the ring is full
+    /// @param event Trace event
+    /// @param start_us micros() at the start of the event
+    /// @param duration_us Duration in microseconds
+    /// @param arg Event argument
+    /// @param instant Whether the event is a point in time rather than a span
+    void recordTrace(MENU::structs::TRACE_EVENT event, uint32_t start_us, uint32_t duration_us, uint16_t arg, bool instant);
+#endif
+
+    /// @brief Calculate the fingerprint of the frame about to be drawn
+    /// @param showCursor Whether the cursor is shown.
+    /// @return FNV-1a hash of the text and the render state
+    uint32_t frameFingerprint(bool showCursor);
+
+    /// @brief Calculate the fingerprint of the render state, without the text
+    /// @param showCursor Whether the cursor is shown.
+    /// @return FNV-1a hash of the buffer, page, anchor, cursor, font, highlight and blink phase
+    uint32_t renderStateHash(bool showCursor);
+
+    /// @brief Hash a text buffer up to its terminator
+    /// @param text Text to hash
+    /// @param size Size of the text buffer
+    /// @return FNV-1a hash of the text
+    static uint32_t hashText(const char *text, size_t size);
+
+    /// @brief Add bytes to an FNV-1a hash
+    /// @param hash Hash to add to
+    /// @param data Bytes to hash
+    /// @param len Number of bytes
+    /// @return Updated hash
+    static uint32_t hashBytes(uint32_t hash, const void *data, size_t len);
+
+    /// @brief Send the frame buffer to the display, only changed tiles if dirty tile tracking is enabled
+    void flushDisplay();
+
+    /// @brief Send one tile row of the frame buffer to the display, only changed tiles if dirty tile tracking is enabled
+    /// @param ty Index of the tile row
+    void flushTileRow(uint8_t ty);
+
+    /// @brief Check if a tile differs from the last frame sent
+    /// @param ty Index of the tile row
+    /// @param offset Byte offset of the tile in the frame buffer
+    /// @return True if the tile has changed, false otherwise
+    bool isTileDirty(uint8_t ty, uint16_t offset);
+
+    /// @brief Get a bit mask with one bit set for every tile row of the frame buffer
+    /// @return Tile row mask
+    uint32_t allTileRowsMask();
+
+    /// @brief Write the tiles that changed since the last mirror frame to the mirror stream
+    void writeMirrorFrame();
+
+    /// @brief Write bytes of a mirror frame and add them to its checksum
+    /// @param data Bytes to write
+    /// @param len Number of bytes
+    void writeMirrorBytes(const uint8_t *data, uint16_t len);
+
+    /// @brief Write bytes of a mirror frame PackBits encoded
+    /// @param data Bytes to encode
+    /// @param len Number of bytes
+    void writeMirrorPacked(const uint8_t *data, uint16_t len);
+
+    /// @brief Render text for the current menu page, running its callback when due
     void renderMenuPageText();
 
-    /// @brief Render text for the current error page
+    /// @brief Format the fields of a template page whose value changed into the page buffer
+    /// @param page Template page
+    /// @param force True to format all fields
+    /// @return Bit mask of the fields that were formatted
+    uint32_t updateTemplateFields(MENU::structs::menuPageInfo *page, bool force);
+
+    /// @brief Expand the layout of a template page into its buffer, reserving the width of every field
+    /// @param page Template page
+    /// @return True if the layout fits the buffer and has one "{}" per field, false otherwise
+    static bool expandTemplateLayout(MENU::structs::menuPageInfo *page);
+
+    /// @brief Format a template field into its slot of a page buffer
+    /// @param field Field to format
+    /// @param page_buffer Page buffer
+    static void formatTemplateField(const MENU::structs::templateField &field, char *page_buffer);
+
+    /// @brief Get the raw value of a template field, or a hash of it for STRING fields
+    /// @param field Field to read
+    /// @return Value used to detect changes
+    static uint32_t readTemplateField(const MENU::structs::templateField &field);
+
+    /// @brief Check if the frame on the display is the current template page, so fields can be redrawn in place
+    /// @return True if the changed fields can be drawn over the last frame
+    bool canRedrawTemplateFields();
+
+    /// @brief Draw changed template fields over the last frame and flush it
+    /// @param changed Bit mask of the changed fields
+    void redrawTemplateFields(uint32_t changed);
+
+    /// @brief Read the visible lines of a streamed page into its buffer, clamping top_line to the document
+    /// @param page Streamed page
+    void fillStreamWindow(MENU::structs::menuPageInfo *page);
+
+    /// @brief Find the offset of a line of a streamed document, starting from the nearest checkpoint
+    /// @param document Streamed document
+    /// @param line Line to find
+    /// @param scratch Buffer for the bytes read while scanning
+    /// @param scratch_size Size of scratch
+    /// @param offset Offset of the line
+    /// @return True if the line was found, false if the document ends before it
+    bool locateStreamLine(MENU::structs::streamDocument *document, uint32_t line, char *scratch, uint16_t scratch_size, uint32_t &offset);
+
+    /// @brief Record the offset of a line if it is the next checkpoint, halving the checkpoints when they are full
+    /// @param document Streamed document
+    /// @param line Line index
+    /// @param offset Offset of the line
+    static void addStreamCheckpoint(MENU::structs::streamDocument *document, uint32_t line, uint32_t offset);
+
+    /// @brief Copy the visible lines of a log page into its buffer
+    /// @param page Log page
+    /// @return Number of lines the window moved while following the tail with all lines shown, 0 otherwise
+    uint8_t buildLogWindow(MENU::structs::menuPageInfo *page);
+
+    /// @brief Check if the last frame can be moved up to show new lines of a log page
+    /// @param lines Number of new lines
+    /// @return True if the frame can be scrolled, false if it has to be drawn
+    bool canScrollLogTail(uint8_t lines);
+
+    /// @brief Move the last frame up by whole lines, draw the new lines of the log page and flush it
+    /// @param lines Number of new lines
+    void scrollLogTail(uint8_t lines);
+
+    /// @brief Move the frame buffer contents up, clearing the rows moved in at the bottom
+    /// @param pixels Number of pixel rows to move
+    void scrollFrameUp(uint16_t pixels);
+
+    /// @brief Check if the callback of a page is due
+    /// @param page Page to check
+    /// @param now Current time in milliseconds
+    /// @return True if the callback should run, false otherwise
+    bool isPageRefreshDue(MENU::structs::menuPageInfo *page, unsigned long now);
+
+    /// @brief Record that the callback of a page ran
+    /// @param page Page that was refreshed
+    /// @param now Current time in milliseconds
+    void markPageRefreshed(MENU::structs::menuPageInfo *page, unsigned long now);
+
+    /// @brief Apply and reset coalesced page and item moves
+    /// @param page_delta Accumulated page moves
+    /// @param item_delta Accumulated item moves
+    void applyInputMoves(int &page_delta, int &item_delta);
+
+    /// @brief Dim, switch off or wake the display depending on the time since the last activity
+    /// @return True if the display is asleep and the frame must not be rendered
+    bool applyIdlePolicy();
+
+    /// @brief Switch the display to a power state
+    /// @param state New power state
+    void setPowerState(MENU::structs::POWER_STATE state);
+
+    /// @brief Get the time until the idle policy next changes the power state
+    /// @param now Current millis()
+    /// @return Milliseconds until the next power state change, OLED_MENU_NO_DEADLINE if none
+    uint32_t getIdleStepRemaining(unsigned long now);
+
+    /// @brief Scan a printf conversion specification
+    /// @param spec Pointer to the character after '%'
+    /// @param conversion Set to the conversion character
+    /// @param stars Set to the number of '*' width and precision arguments
+    /// @param is_long Set when the argument is a long
+    /// @return Pointer to the character after the conversion, nullptr if the specification is not supported
+    static const char *scanFormatSpec(const char *spec, char &conversion, uint8_t &stars, bool &is_long);
+
+    /// @brief Format an error record, appending the repeat count
+    /// @param record Error record to format
+    /// @param out Output buffer
+    /// @param size Size of the output buffer
+    static void formatErrorRecord(const MENU::structs::errorRecord &record, char *out, uint16_t size);
+
+    /// @brief Render text for the current error page, formatting the oldest error if it changed
     void renderErrorPageText();
 };
 
+/// @brief OledMenu with statically allocated page tables and display buffer
+/// @tparam MaxPages Maximum number of menu pages
+/// @tparam MaxErrorPages Maximum number of error pages
+/// @tparam BufferSize Size of the display buffer, 0 to allocate a buffer of the size given to the constructor
+template <uint8_t MaxPages, uint8_t MaxErrorPages = 1, uint16_t BufferSize = 0>
+class StaticOledMenu : public OledMenu
+{
+public:
+    /// @brief Constructor for StaticOledMenu with a display buffer of BufferSize bytes, nothing is allocated
+    /// @param display Reference to the U8G2 display object
+    /// @param text_blink_delay Delay for text blinking
+    StaticOledMenu(U8G2 &display, uint32_t text_blink_delay)
+        : OledMenu(display, BufferSize, text_blink_delay, page_table, MaxPages, error_page_table, MaxErrorPages,
+                   display_buffer_storage)
+    {
+        static_assert(BufferSize > 0, "Give the display buffer size as BufferSize or to the constructor");
+    }
+
+    /// @brief Constructor for StaticOledMenu with an allocated display buffer, for BufferSize 0
+    /// @param display Reference to the U8G2 display object
+    /// @param buffer_size Size of the display buffer
+    /// @param text_blink_delay Delay for text blinking
+    StaticOledMenu(U8G2 &display, uint16_t buffer_size, uint32_t text_blink_delay)
+        : OledMenu(display, buffer_size, text_blink_delay, page_table, MaxPages, error_page_table, MaxErrorPages)
+    {
+        static_assert(BufferSize == 0, "The display buffer size is already given as BufferSize");
+    }
+
+private:
+    MENU::structs::menuPageInfo page_table[MaxPages];        ///< Menu page storage
+    MENU::structs::errorPageInfo error_page_table[MaxErrorPages]; ///< Error page storage
+    uint8_t display_buffer_storage[BufferSize > 0 ? BufferSize : 1]; ///< Display buffer storage, unused for BufferSize 0
+};
+
 #endif // SSD1306_OLED_MENU
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "U8G2OledMenuManager.h"
+
+/// @brief Constructor for OledMenuManager using a caller provided surface table
+/// @param surface_table Storage for the surfaces
+/// @param surface_table_size Number of entries in surface_table, at most 32
+/// @param budget_us Bus time budget of a service() call in microseconds, 0 for no budget
+OledMenuManager::OledMenuManager(MENU::manager::surface *surface_table, uint8_t surface_table_size, uint16_t budget_us)
+    : surfaces(surface_table), max_surfaces(surface_table_size > 32 ? 32 : surface_table_size), num_surfaces(0),
+      budget(budget_us), change_clock(0)
+{
+}
+
+/// @brief Add a menu to the manager, switching it to the asynchronous flush
+/// @param menu Menu of a display on the shared bus
+/// @return True if the menu was added, false if the table is full or the display has no full frame buffer
+bool OledMenuManager::addSurface(OledMenu &menu)
+{
+    if (num_surfaces >= max_surfaces)
+    {
+        return false;
+    }
+
+    // One row per menu service() call, so the manager picks the display for every row
+    if (!menu.setAsyncFlush(true, 1, 0))
+    {
+        return false;
+    }
+
+    MENU::manager::surface &entry = surfaces[num_surfaces];
+    entry.menu = &menu;
+    entry.last_change = 0;
+    entry.frames_drawn = menu.getFramesDrawn();
+    entry.row_us = 0;
+    entry.waiting = 0;
+    num_surfaces++;
+    return true;
+}
+
+/// @brief Render the menus of all displays, without using the bus
+void OledMenuManager::refreshDisplays()
+{
+    for (uint8_t i = 0; i < num_surfaces; i++)
+    {
+        MENU::manager::surface &entry = surfaces[i];
+        entry.menu->refreshDisplay();
+        if (entry.menu->getFramesDrawn() != entry.frames_drawn)
+        {
+            entry.frames_drawn = entry.menu->getFramesDrawn();
+            entry.last_change = ++change_clock;
+        }
+    }
+}
+
+/// @brief Send queued tile rows of the displays within the time budget
+/// @return Number of tile rows sent
+uint8_t OledMenuManager::service()
+{
+    unsigned long start = micros();
+    uint32_t served = 0;
+    uint8_t rows_sent = 0;
+
+    int8_t next;
+    while ((next = pickSurface()) >= 0)
+    {
+        MENU::manager::surface &entry = surfaces[next];
+
+        // Stop before a row that is expected to overrun the budget
+        if (rows_sent > 0 && budget > 0 && micros() - start + entry.row_us > budget)
+        {
+            break;
+        }
+
+        unsigned long row_start = micros();
+        uint8_t rows = entry.menu->service();
+        if (rows == 0)
+        {
+            break;
+        }
+        uint16_t row_us = (micros() - row_start) / rows;
+        entry.row_us = entry.row_us == 0 ? row_us : (entry.row_us * 3 + row_us) / 4;
+        entry.waiting = 0;
+        served |= 1UL << next;
+        rows_sent += rows;
+    }
+
+    // Age the displays that were passed over
+    for (uint8_t i = 0; i < num_surfaces; i++)
+    {
+        if ((served & (1UL << i)) == 0 && surfaces[i].menu->isFlushInProgress() && surfaces[i].waiting < 0xFF)
+        {
+            surfaces[i].waiting++;
+        }
+    }
+    return rows_sent;
+}
+
+/// @brief Pick the surface that sends the next tile row
+/// @return Index of the surface, -1 if no rows are queued
+int8_t OledMenuManager::pickSurface()
+{
+    int8_t recent = -1;
+    int8_t starved = -1;
+    for (uint8_t i = 0; i < num_surfaces; i++)
+    {
+        MENU::manager::surface &entry = surfaces[i];
+        if (!entry.menu->isFlushInProgress())
+        {
+            continue;
+        }
+        if (entry.waiting >= OLED_MENU_MANAGER_MAX_WAIT && (starved < 0 || entry.waiting > surfaces[starved].waiting))
+        {
+            starved = i;
+        }
+        if (recent < 0 || entry.last_change > surfaces[recent].last_change)
+        {
+            recent = i;
+        }
+    }
+    return starved >= 0 ? starved : recent;
+}
+
+/// @brief Set the bus time budget of a service() call
+/// @param budget_us Budget in microseconds, 0 for no budget
+void OledMenuManager::setBudget(uint16_t budget_us)
+{
+    budget = budget_us;
+}
+
+/// @brief Check if any display still has tile rows queued
+/// @return True if rows are queued, false otherwise
+bool OledMenuManager::isFlushInProgress()
+{
+    for (uint8_t i = 0; i < num_surfaces; i++)
+    {
+        if (surfaces[i].menu->isFlushInProgress())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Get the number of surfaces
+/// @return Number of surfaces
+uint8_t OledMenuManager::getNumSurfaces()
+{
+    return num_surfaces;
+}
+
+/// @brief Get the menu of a surface
+/// @param index Index of the surface
+/// @return Pointer to the menu, nullptr if the surface does not exist
+OledMenu *OledMenuManager::getSurface(uint8_t index)
+{
+    return index < num_surfaces ? surfaces[index].menu : nullptr;
+}
@@ -0,0 +1,102 @@
+#ifndef SSD1306_OLED_MENU_MANAGER
+#define SSD1306_OLED_MENU_MANAGER
+
+#include <Arduino.h>
+#include "U8G2OledMenu.h"
+
+// Number of service() calls a display with queued rows may be passed over before it goes first
+#ifndef OLED_MENU_MANAGER_MAX_WAIT
+#define OLED_MENU_MANAGER_MAX_WAIT 4
+#endif
+
+namespace MENU
+{
+    namespace manager
+    {
+        /// @brief Struct for a menu surface owned by the display manager
+        struct surface
+        {
+            OledMenu *menu = nullptr;  ///< Menu drawing to the display
+            uint32_t last_change = 0;  ///< Manager clock of the last new frame, higher is more recent
+            uint32_t frames_drawn = 0; ///< Frames drawn by the menu when last checked
+            uint16_t row_us = 0;       ///< Average time to send a tile row in microseconds
+            uint8_t waiting = 0;       ///< Number of service() calls passed over with rows queued
+        };
+    }; // namespace manager
+};
+
+/// @brief Shares one bus between the menus of several displays
+/// @note Every menu renders into its own frame buffer, the manager decides which display sends a tile row next.
+///       The most recently changed display goes first, a display passed over OLED_MENU_MANAGER_MAX_WAIT times
+///       takes precedence so none of them starves.
+class OledMenuManager
+{
+public:
+    /// @brief Constructor for OledMenuManager using a caller provided surface table
+    /// @param surface_table Storage for the surfaces
+    /// @param surface_table_size Number of entries in surface_table, at most 32
+    /// @param budget_us Bus time budget of a service() call in microseconds, 0 for no budget
+    OledMenuManager(MENU::manager::surface *surface_table, uint8_t surface_table_size, uint16_t budget_us);
+
+    /// @brief Add a menu to the manager, switching it to the asynchronous flush
+    /// @param menu Menu of a display on the shared bus
+    /// @return True if the menu was added, false if the table is full or the display has no full frame buffer
+    bool addSurface(OledMenu &menu);
+
+    /// @brief Render the menus of all displays, without using the bus
+    void refreshDisplays();
+
+    /// @brief Send queued tile rows of the displays within the time budget
+    /// @return Number of tile rows sent
+    /// @note At least one row is sent per call when rows are queued, so frames always make progress.
+    uint8_t service();
+
+    /// @brief Set the bus time budget of a service() call
+    /// @param budget_us Budget in microseconds, 0 for no budget
+    void setBudget(uint16_t budget_us);
+
+    /// @brief Check if any display still has tile rows queued
+    /// @return True if rows are queued, false otherwise
+    bool isFlushInProgress();
+
+    /// @brief Get the number of surfaces
+    /// @return Number of surfaces
+    uint8_t getNumSurfaces();
+
+    /// @brief Get the menu of a surface
+    /// @param index Index of the surface
+    /// @return Pointer to the menu, nullptr if the surface does not exist
+    OledMenu *getSurface(uint8_t index);
+
+private:
+    MENU::manager::surface *surfaces; ///< Table of surfaces
+    uint8_t max_surfaces;             ///< Capacity of the surface table
+    uint8_t num_surfaces;             ///< Number of surfaces
+    uint16_t budget;                  ///< Bus time budget of a service() call in microseconds
+    uint32_t change_clock;            ///< Counter ordering new frames
+
+    /// @brief Pick the surface that sends the next tile row
+    /// @return Index of the surface, -1 if no rows are queued
+    int8_t pickSurface();
+};
+
+/// @brief OledMenuManager with a statically allocated surface table
+/// @tparam MaxSurfaces Maximum number of displays
+template <uint8_t MaxSurfaces>
+class StaticOledMenuManager : public OledMenuManager
+{
+public:
+    static_assert(MaxSurfaces > 0 && MaxSurfaces <= 32, "StaticOledMenuManager supports 1 to 32 displays");
+
+    /// @brief Constructor for StaticOledMenuManager
+    /// @param budget_us Bus time budget of a service() call in microseconds, 0 for no budget
+    StaticOledMenuManager(uint16_t budget_us)
+        : OledMenuManager(surface_table, MaxSurfaces, budget_us)
+    {
+    }
+
+private:
+    MENU::manager::surface surface_table[MaxSurfaces]; ///< Surface storage
+};
+
+#endif // SSD1306_OLED_MENU_MANAGER
@@ -0,0 +1,81 @@
+#include "U8G2OledMenuSim.h"
+
+/// @brief Constructor for SimulatedDisplay
+/// @param mode Frame buffer mode of the display
+/// @param bus_clock_hz Bus clock used to estimate transfer time
+SimulatedDisplay::SimulatedDisplay(MENU::sim::BUFFER_MODE mode, uint32_t bus_clock_hz)
+    : U8G2(), bus_clock(bus_clock_hz)
+{
+    switch (mode)
+    {
+    case MENU::sim::PAGE_BUFFER_1:
+        u8g2_Setup_ssd1306_i2c_128x64_noname_1(&u8g2, U8G2_R0, byteCallback, gpioAndDelayCallback);
+        break;
+    case MENU::sim::PAGE_BUFFER_2:
+        u8g2_Setup_ssd1306_i2c_128x64_noname_2(&u8g2, U8G2_R0, byteCallback, gpioAndDelayCallback);
+        break;
+    default:
+        u8g2_Setup_ssd1306_i2c_128x64_noname_f(&u8g2, U8G2_R0, byteCallback, gpioAndDelayCallback);
+        break;
+    }
+    u8x8_SetUserPtr(getU8x8(), this);
+}
+
+/// @brief Get the bus traffic since the last reset
+/// @return Bus statistics
+const MENU::sim::busStats &SimulatedDisplay::getBusStats()
+{
+    return bus_stats;
+}
+
+/// @brief Reset the bus traffic counters
+void SimulatedDisplay::resetBusStats()
+{
+    bus_stats.bytes_sent = 0;
+    bus_stats.transfers = 0;
+}
+
+/// @brief Estimate the time the bus traffic since the last reset would take
+/// @return Estimated transfer time in microseconds
+uint32_t SimulatedDisplay::getBusMicros()
+{
+    // I2C: 8 data bits plus ACK per byte, start, address and stop per transfer
+    uint64_t bits = static_cast<uint64_t>(bus_stats.bytes_sent) * 9 + static_cast<uint64_t>(bus_stats.transfers) * 20;
+    return static_cast<uint32_t>(bits * 1000000UL / bus_clock);
+}
+
+/// @brief Get the frame buffer size of the display
+/// @return Frame buffer size in bytes
+uint16_t SimulatedDisplay::getFrameBufferSize()
+{
+    return getBufferTileHeight() * getBufferTileWidth() * 8;
+}
+
+/// @brief U8x8 byte callback that counts the bytes instead of sending them
+uint8_t SimulatedDisplay::byteCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void * /* arg_ptr */)
+{
+    SimulatedDisplay *display = reinterpret_cast<SimulatedDisplay *>(u8x8_GetUserPtr(u8x8));
+    if (display == nullptr)
+    {
+        return 1; // Called from u8g2 setup before the user pointer is set
+    }
+    switch (msg)
+    {
+    case U8X8_MSG_BYTE_SEND:
+        display->bus_stats.bytes_sent += arg_int;
+        break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+        display->bus_stats.transfers++;
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+/// @brief U8x8 GPIO and delay callback that does nothing
+uint8_t SimulatedDisplay::gpioAndDelayCallback(u8x8_t * /* u8x8 */, uint8_t /* msg */, uint8_t /* arg_int */,
+                                               void * /* arg_ptr */)
+{
+    return 1;
+}
@@ -0,0 +1,65 @@
+#ifndef SSD1306_OLED_MENU_SIM
+#define SSD1306_OLED_MENU_SIM
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+namespace MENU
+{
+    namespace sim
+    {
+        /// @brief Enumeration for the frame buffer mode of the simulated display
+        enum BUFFER_MODE
+        {
+            FULL_BUFFER = 0,   ///< Full frame buffer, like the _F_ constructors
+            PAGE_BUFFER_1 = 1, ///< One tile row page buffer, like the _1_ constructors
+            PAGE_BUFFER_2 = 2  ///< Two tile row page buffer, like the _2_ constructors
+        };
+
+        /// @brief Struct for the bus traffic of the simulated display
+        struct busStats
+        {
+            uint32_t bytes_sent = 0; ///< Number of bytes sent over the bus
+            uint32_t transfers = 0;  ///< Number of bus transfers (start to end condition)
+        };
+    }; // namespace sim
+};
+
+/// @brief In-memory SSD1306 128x64 I2C display that counts the bytes it would put on the bus
+/// @note Nothing is written to the hardware, the I2C byte stream is only counted. Use it to
+///       measure the menu off the panel or on boards without a display attached.
+class SimulatedDisplay : public U8G2
+{
+public:
+    /// @brief Constructor for SimulatedDisplay
+    /// @param mode Frame buffer mode of the display
+    /// @param bus_clock_hz Bus clock used to estimate transfer time
+    SimulatedDisplay(MENU::sim::BUFFER_MODE mode = MENU::sim::FULL_BUFFER, uint32_t bus_clock_hz = 400000);
+
+    /// @brief Get the bus traffic since the last reset
+    /// @return Bus statistics
+    const MENU::sim::busStats &getBusStats();
+
+    /// @brief Reset the bus traffic counters
+    void resetBusStats();
+
+    /// @brief Estimate the time the bus traffic since the last reset would take
+    /// @return Estimated transfer time in microseconds
+    uint32_t getBusMicros();
+
+    /// @brief Get the frame buffer size of the display
+    /// @return Frame buffer size in bytes
+    uint16_t getFrameBufferSize();
+
+private:
+    MENU::sim::busStats bus_stats; ///< Bus traffic since the last reset
+    uint32_t bus_clock;            ///< Bus clock in Hz
+
+    /// @brief U8x8 byte callback that counts the bytes instead of sending them
+    static uint8_t byteCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+    /// @brief U8x8 GPIO and delay callback that does nothing
+    static uint8_t gpioAndDelayCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+};
+
+#endif // SSD1306_OLED_MENU_SIM